@@ -1,5 +1,7 @@
 #include "../../knapsack-problem/knapsack_problem.hpp"
 #include "../../genetic_method/src/evolution_tree.hpp"
+#include "../../src/tools/random.hpp"
+#include "../../src/genetic_algorithm/operators.hpp"
 #include "evolution_log.hpp"
 
 #include <chrono>
@@ -24,43 +26,74 @@ struct Data
     size_t generation_size, num_new_pairs;
     double mutation_coef;
     size_t max_times;
+    // shared by the operators of all nodes, the nodes of this example run one after another
+    HeuristicAlgorithm::Tools::Random random;
 };
 
 
-struct FitnessFunction: public FitnessFunctionWrapper<bool, long long>
+// Value of the packed items (0 if the knapsack is overweight), the raw sums are kept for incremental evaluation.
+struct KnapsackFitness
+{
+    long long fitness_ = 0;
+    long long value_ = 0;
+    long long weight_ = 0;
+
+    bool operator<(const KnapsackFitness& other) const { return fitness_ < other.fitness_; }
+    bool operator>(const KnapsackFitness& other) const { return fitness_ > other.fitness_; }
+    bool operator==(const KnapsackFitness& other) const { return fitness_ == other.fitness_; }
+};
+
+
+struct FitnessFunction: public FitnessFunctionWrapper<bool, KnapsackFitness>
 {
     FitnessFunction(Data& data): data_(data) {}
 
-    long long operator()(const Chromosome<bool, long long>& ch) override
+    KnapsackFitness operator()(const Chromosome<bool, KnapsackFitness>& ch) override
     {
-        double value = 0., weight = 0.;
-        for (size_t i = 0; i < data_.kp.size_; ++i)
+        KnapsackFitness res;
+        ch.cget().forEachSetBit([this, &res](size_t i)
         {
-            if (ch.cget()[i])
-            {
-                value += data_.kp.items_[i].value_;
-                weight += data_.kp.items_[i].weight_;
-            }
-        }
-        if (weight > data_.kp.knapsack_capacity_)
+            res.value_ += data_.kp.items_[i].value_;
+            res.weight_ += data_.kp.items_[i].weight_;
+        });
+        res.fitness_ = res.weight_ > (long long)data_.kp.knapsack_capacity_ ? 0 : res.value_;
+        return res;
+    }
+
+    Data& data_;
+};
+
+
+struct IncrementalFitnessFunction: public IncrementalFitnessFunctionWrapper<bool, KnapsackFitness>
+{
+    IncrementalFitnessFunction(Data& data): data_(data) {}
+
+    KnapsackFitness operator()(const Chromosome<bool, KnapsackFitness>& ch, const KnapsackFitness& parent,
+                               const std::vector<std::pair<size_t, bool>>& changes) override
+    {
+        KnapsackFitness res = parent;
+        for (const auto& [i, old_gene]: changes)
         {
-            value = 0;
+            long long sign = old_gene ? -1 : 1;
+            res.value_ += sign * data_.kp.items_[i].value_;
+            res.weight_ += sign * data_.kp.items_[i].weight_;
         }
-        return value;
+        res.fitness_ = res.weight_ > (long long)data_.kp.knapsack_capacity_ ? 0 : res.value_;
+        return res;
     }
 
     Data& data_;
 };
 
 
-struct StartPopulation_Zeros: public StartPopulationWrapper<bool, long long>
+struct StartPopulation_Zeros: public StartPopulationWrapper<bool, KnapsackFitness>
 {
     StartPopulation_Zeros(Data& data): data_(data) {}
 
-    Population<bool, long long> operator()() override
+    Population<bool, KnapsackFitness> operator()() override
     {
-        Generation<bool, long long> generation(data_.generation_size, Chromosome<bool, long long>(data_.kp.size_));
-        Population<bool, long long> population(2);
+        Generation<bool, KnapsackFitness> generation(data_.generation_size, Chromosome<bool, KnapsackFitness>(data_.kp.size_));
+        Population<bool, KnapsackFitness> population(2);
         population.get().push(std::move(generation));
         return population;
     }
@@ -69,24 +102,19 @@ struct StartPopulation_Zeros: public StartPopulationWrapper<bool, long long>
 };
 
 
-struct Mutation: public MutationWrapper<bool, long long>
+struct Mutation: public MutationWrapper<bool, KnapsackFitness>
 {
     Mutation(Data& data): data_(data) {}
 
-    void operator()(Generation<bool, long long>& generation) override
+    void operator()(Generation<bool, KnapsackFitness>& generation) override
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<double> urd(0., 1.);
         for (size_t i = generation.get().size() - data_.num_new_pairs; i < generation.get().size(); ++i)
         {
-            for (size_t j = 0; j < generation.get()[i].get().size(); ++j)
+            Chromosome<bool, KnapsackFitness>& chromosome = generation.get()[i];
+            data_.random.forEachSuccess(chromosome.cget().size(), data_.mutation_coef, [&chromosome](size_t j)
             {
-                if (urd(gen) < data_.mutation_coef)
-                {
-                    generation.get()[i].get()[j] = !generation.get()[i].get()[j];
-                }
-            }
+                chromosome.changeGene(j, !chromosome.cget()[j]);
+            });
         }
     }
 
@@ -94,14 +122,14 @@ struct Mutation: public MutationWrapper<bool, long long>
 };
 
 
-struct Crossingover: public CrossingoverWrapper<bool, long long>
+struct Crossingover: public CrossingoverWrapper<bool, KnapsackFitness>
 {
     Crossingover(Data& data): data_(data) {}
 
-    Generation<bool, long long> operator()(const Population<bool, long long>& population) override
+    Generation<bool, KnapsackFitness> operator()(const Population<bool, KnapsackFitness>& population) override
     {
-        const Generation<bool, long long>& last_generation = population.get()[0];
-        Generation<bool, long long> generation;
+        const Generation<bool, KnapsackFitness>& last_generation = population.get()[0];
+        Generation<bool, KnapsackFitness> generation;
         size_t generation_size = data_.generation_size;
         size_t chromosome_size = data_.kp.size_;
         for (size_t j = 0; j < data_.num_new_pairs / generation_size; ++j)
@@ -118,60 +146,56 @@ struct Crossingover: public CrossingoverWrapper<bool, long long>
 };
 
 
-struct Selection: public SelectionWrapper<bool, long long>
+struct Selection: public SelectionWrapper<bool, KnapsackFitness>
 {
     Selection(Data& data): data_(data) {}
 
-    void operator()(Generation<bool, long long>& generation) override
+    void operator()(Generation<bool, KnapsackFitness>& generation) override
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::sort(generation.get().begin(), generation.get().end(), [](const Chromosome<bool, long long>& ch1, const Chromosome<bool, long long>& ch2)
-        {
-            return ch1.getFitness() > ch2.getFitness();
-        });
-        std::vector<size_t> probabilities(generation.get().size());
-        probabilities[0] = generation.get()[0].getFitness().value() + 1ULL;
-        for (size_t i = 1; i < generation.get().size(); ++i)
+        size_t num_elite = (data_.generation_size + 9) / 10;
+        partitionElite(generation, num_elite);
+        weights_.resize(generation.get().size());
+        for (size_t i = 0; i < generation.get().size(); ++i)
         {
-            probabilities[i] = probabilities[i - 1] + generation.get()[i].getFitness().value() + 1ULL;
+            weights_[i] = generation.get()[i].getFitness().value().fitness_ + 1.;
         }
-        std::uniform_int_distribution<size_t> uid(0, probabilities.back());
-        Generation<bool, long long> new_generation(data_.generation_size);
-        for (size_t i = 0; i < data_.generation_size*0.1; ++i)
+        alias_table_.assign(weights_.begin(), weights_.end());
+        Generation<bool, KnapsackFitness> new_generation(data_.generation_size);
+        for (size_t i = 0; i < num_elite && i < generation.get().size(); ++i)
         {
             new_generation.get()[i] = generation.get()[i];
         }
-        for (size_t i = data_.generation_size*0.1; i < data_.generation_size*0.9; ++i)
+        for (size_t i = num_elite; i < data_.generation_size*0.9; ++i)
         {
-            size_t ch_ind = std::lower_bound(probabilities.begin(), probabilities.end(), uid(gen)) - probabilities.begin();
-            new_generation.get()[i] = generation.get()[ch_ind];
+            new_generation.get()[i] = generation.get()[alias_table_(data_.random)];
         }
-        for (size_t i = data_.generation_size*0.9; i < data_.generation_size; ++i)
+        for (size_t i = std::max<size_t>(num_elite, data_.generation_size*0.9); i < data_.generation_size; ++i)
         {
-            new_generation.get()[i] = Chromosome<bool, long long>(data_.kp.size_, false);
-            new_generation.get()[i].getFitness() = 0;
+            new_generation.get()[i] = Chromosome<bool, KnapsackFitness>(data_.kp.size_, false);
+            new_generation.get()[i].getFitness() = KnapsackFitness();
         }
         std::swap(generation, new_generation);
     }
 
     Data& data_;
+    HeuristicAlgorithm::Tools::AliasTable alias_table_;
+    std::vector<double> weights_;
 };
 
 
-struct ConditionsForStoppingImprovement: public ConditionsForStoppingWrapper<bool, long long>
+struct ConditionsForStoppingImprovement: public ConditionsForStoppingWrapper<bool, KnapsackFitness>
 {
     ConditionsForStoppingImprovement(Data& data): data_(data){}
 
-    bool operator()(const Population<bool, long long>& population) override
+    bool operator()(const Population<bool, KnapsackFitness>& population) override
     {
         cur_times_ += 1;
         for (const auto& chromosome: population.get()[0].get())
         {
-            if (chromosome.getFitness() > best_res_)
+            if (chromosome.getFitness().value().fitness_ > best_res_)
             {
                 cur_times_ = 0;
-                best_res_ = chromosome.getFitness().value();
+                best_res_ = chromosome.getFitness().value().fitness_;
             }
         }
         if (cur_times_ == data_.max_times)
@@ -187,17 +211,17 @@ struct ConditionsForStoppingImprovement: public ConditionsForStoppingWrapper<boo
 };
 
 
-struct PoolingPopulations: public PoolingPopulationsWrapper<bool, long long>
+struct PoolingPopulations: public PoolingPopulationsWrapper<bool, KnapsackFitness>
 {
     PoolingPopulations(Data& data): data_(data) {}
 
-    Population<bool, long long> operator()(std::vector<Population<bool, long long>>& populations) override
+    Population<bool, KnapsackFitness> operator()(std::vector<Population<bool, KnapsackFitness>>& populations) override
     {
-        Generation<bool, long long> generation;
+        Generation<bool, KnapsackFitness> generation;
         for (size_t i = 0; i < populations.size() - 1; ++i)
         {
-            Generation<bool, long long> tmp = populations[i].get()[0].get();
-            std::sort(tmp.get().begin(), tmp.get().end(), [](const Chromosome<bool, long long>& a, const Chromosome<bool, long long>& b)
+            Generation<bool, KnapsackFitness> tmp = populations[i].get()[0].get();
+            std::sort(tmp.get().begin(), tmp.get().end(), [](const Chromosome<bool, KnapsackFitness>& a, const Chromosome<bool, KnapsackFitness>& b)
             {
                 return a.getFitness().value() > b.getFitness().value();
             });
@@ -206,8 +230,8 @@ struct PoolingPopulations: public PoolingPopulationsWrapper<bool, long long>
                 generation.get().push_back(std::move(tmp.get()[j]));
             }
         }
-        Generation<bool, long long> tmp = populations.back().get()[0].get();
-        std::sort(tmp.get().begin(), tmp.get().end(), [](const Chromosome<bool, long long>& a, const Chromosome<bool, long long>& b)
+        Generation<bool, KnapsackFitness> tmp = populations.back().get()[0].get();
+        std::sort(tmp.get().begin(), tmp.get().end(), [](const Chromosome<bool, KnapsackFitness>& a, const Chromosome<bool, KnapsackFitness>& b)
         {
             return a.getFitness().value() > b.getFitness().value();
         });
@@ -215,7 +239,7 @@ struct PoolingPopulations: public PoolingPopulationsWrapper<bool, long long>
         {
             generation.get().push_back(std::move(tmp.get()[j]));
         }
-        Population<bool, long long> res(2);
+        Population<bool, KnapsackFitness> res(2);
         res.get().push(std::move(generation));
         return res;
     }
@@ -224,11 +248,11 @@ struct PoolingPopulations: public PoolingPopulationsWrapper<bool, long long>
 };
 
 
-struct StartEvolutionLog: public StartEvolutionLogWrapper<bool, long long>
+struct StartEvolutionLog: public StartEvolutionLogWrapper<bool, KnapsackFitness>
 {
     StartEvolutionLog(NodeLog& node_log): node_log_(node_log) {}
 
-    void operator()(const Population<bool, long long>& generation, const std::string& id) override
+    void operator()(const Population<bool, KnapsackFitness>& generation, const std::string& id) override
     {
         node_log_.evolution_start();
     }
@@ -236,11 +260,11 @@ struct StartEvolutionLog: public StartEvolutionLogWrapper<bool, long long>
     NodeLog& node_log_;
 };
 
-struct EndEvolutionLog: public EndEvolutionLogWrapper<bool, long long>
+struct EndEvolutionLog: public EndEvolutionLogWrapper<bool, KnapsackFitness>
 {
     EndEvolutionLog(NodeLog& node_log): node_log_(node_log) {}
 
-    void operator()(const Population<bool, long long>& generation, const std::string& id) override
+    void operator()(const Population<bool, KnapsackFitness>& generation, const std::string& id) override
     {
         node_log_.evolution_end();
     }
@@ -248,17 +272,17 @@ struct EndEvolutionLog: public EndEvolutionLogWrapper<bool, long long>
     NodeLog& node_log_;
 };
 
-struct NewGenerationLog: public NewGenerationLogWrapper<bool, long long>
+struct NewGenerationLog: public NewGenerationLogWrapper<bool, KnapsackFitness>
 {
     NewGenerationLog(NodeLog& node_log): node_log_(node_log) {}
 
-    void operator()(const Generation<bool, long long>& generation, const std::string& id) override
+    void operator()(const Generation<bool, KnapsackFitness>& generation, const std::string& id) override
     {
         GenerationLog generation_log;
         generation_log.start();
         for (const auto& chromosome: generation.get())
         {
-            generation_log.add(chromosome.getFitness().value());
+            generation_log.add(chromosome.getFitness().value().fitness_);
         }
         generation_log.end();
         node_log_.population_log_.add(std::move(generation_log));
@@ -293,9 +317,10 @@ struct EndNodeLog: public EndNodeLogWrapper
 };
 
 
-Node<bool, long long>& setFuns(Node<bool, long long>& node, Data& data)
+Node<bool, KnapsackFitness>& setFuns(Node<bool, KnapsackFitness>& node, Data& data)
 {
     node.setFitnessFunction(std::make_shared<FitnessFunction>(FitnessFunction(data))).
+        setIncrementalFitnessFunction(std::make_shared<IncrementalFitnessFunction>(IncrementalFitnessFunction(data))).
         setMutation(std::make_shared<Mutation>(Mutation(data))).
         setCrossingover(std::make_shared<Crossingover>(Crossingover(data))).
         setSelection(std::make_shared<Selection>(Selection(data))).
@@ -303,7 +328,7 @@ Node<bool, long long>& setFuns(Node<bool, long long>& node, Data& data)
     return node;
 }
 
-Node<bool, long long>& setLogFuns(Node<bool, long long>& node, NodeLog& node_log)
+Node<bool, KnapsackFitness>& setLogFuns(Node<bool, KnapsackFitness>& node, NodeLog& node_log)
 {
     node.setStartEvolutionLog(std::make_shared<StartEvolutionLog>(StartEvolutionLog(node_log))).
         setNewGenerationLog(std::make_shared<NewGenerationLog>(NewGenerationLog(node_log))).
@@ -314,24 +339,24 @@ Node<bool, long long>& setLogFuns(Node<bool, long long>& node, NodeLog& node_log
 }
 
 
-PopulationNode<bool, long long>& setFuns(PopulationNode<bool, long long>& node, Data& data)
+PopulationNode<bool, KnapsackFitness>& setFuns(PopulationNode<bool, KnapsackFitness>& node, Data& data)
 {
-    setFuns((Node<bool, long long>&)node, data);
+    setFuns((Node<bool, KnapsackFitness>&)node, data);
     node.setStartPopulation(std::make_shared<StartPopulation_Zeros>(StartPopulation_Zeros(data)));
     return node;
 }
 
 
-UnaryNode<bool, long long>& setFuns(UnaryNode<bool, long long>& node, Data& data)
+UnaryNode<bool, KnapsackFitness>& setFuns(UnaryNode<bool, KnapsackFitness>& node, Data& data)
 {
-    setFuns((Node<bool, long long>&)node, data);
+    setFuns((Node<bool, KnapsackFitness>&)node, data);
     return node;
 }
 
 
-K_Node<bool, long long>& setFuns(K_Node<bool, long long>& node, Data& data)
+K_Node<bool, KnapsackFitness>& setFuns(K_Node<bool, KnapsackFitness>& node, Data& data)
 {
-    setFuns((Node<bool, long long>&)node, data);
+    setFuns((Node<bool, KnapsackFitness>&)node, data);
     node.setPoolingPopulations(std::make_shared<PoolingPopulations>(PoolingPopulations(data)));
     return node;
 }
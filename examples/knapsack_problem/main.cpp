@@ -26,8 +26,8 @@ int main()
     data.mutation_coef = 0.001;
     data.num_new_pairs = 400;
 
-    auto node1 = std::make_shared<PopulationNode<bool, long long>>();
-    auto node2 = std::make_shared<UnaryNode<bool, long long>>(node1);
+    auto node1 = std::make_shared<PopulationNode<bool, KnapsackFitness>>();
+    auto node2 = std::make_shared<UnaryNode<bool, KnapsackFitness>>(node1);
     auto node_log1 = std::make_shared<NodeLog>("node1");
     auto node_log2 = std::make_shared<NodeLog>("node2");
 
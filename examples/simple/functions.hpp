@@ -35,22 +35,20 @@ struct FitnessFunction: public FitnessFunctionWrapper<double, double>
 
 struct Mutation: public MutationWrapper<double, double>
 {
-    Mutation(double& coef): coef_(coef) {}
+    Mutation(double& coef, std::shared_ptr<HeuristicAlgorithm::Tools::Random> random): coef_(coef), random_(random) {}
 
     void operator() (Generation_& generation) override
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<double> urd(-coef_, coef_);
         size_t generation_size = generation.get().size();
 
         for (size_t i = generation_size / 2; i < generation_size; ++i)
         {
-            generation.get()[i].get()[0] += urd(gen);
+            generation.get()[i].genes()[0] = generation.get()[i].cget()[0] + random_->uniformReal(-coef_, coef_);
         }
     }
 
     double& coef_;
+    std::shared_ptr<HeuristicAlgorithm::Tools::Random> random_;
 }; 
 
 
@@ -16,7 +16,7 @@ HeuristicAlgorithm::GeneticAlgorithm::GeneticAlgorithm<double, double> make_ga(
     ga.setCrossingover(std::make_shared<Crossingover>());
     ga.setEndEvolutionLog(std::make_shared<EndEvolutionLog>());
     ga.setFitnessFunction(std::make_shared<FitnessFunction>(y, best_res));
-    ga.setMutation(std::make_shared<Mutation>(coef));
+    ga.setMutation(std::make_shared<Mutation>(coef, ga.getRandom()));
     ga.setNewGenerationLog(std::make_shared<NewGenerationLog>(best_res));
     ga.setSelection(std::make_shared<Selection>());
     ga.setStartEvolutionLog(std::make_shared<StartEvolutionLog>(start_time));
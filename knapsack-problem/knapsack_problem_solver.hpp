@@ -2,6 +2,9 @@
 
 #include "knapsack_problem.hpp"
 #include "knapsack_problem_generator.hpp"
+#include "../src/tools/random.hpp"
+#include "../src/tools/alias_table.hpp"
+#include "../src/tools/cancellation.hpp"
 // #include "..\tools\benchmark.hpp"
 // #include "..\tools\loger.hpp"
 #include <vector>
@@ -13,11 +16,11 @@
 #include <chrono>
 #include <sstream>
 
-#define _WORKTIME_(time) std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - time).count()
-
 class KnapsackProblemSolver
 {
 public:
+    using CancellationToken = HeuristicAlgorithm::Tools::CancellationToken;
+
     struct GeneticMethod
     {
         enum StartPopulationType
@@ -83,7 +86,10 @@ public:
         size_t max_generations_;
         size_t max_work_time_;
         double max_fit = 0.;
-        std::chrono::steady_clock::time_point start_time_;
+        CancellationToken deadline_;
+        HeuristicAlgorithm::Tools::Random random_;
+        HeuristicAlgorithm::Tools::AliasTable alias_table_;
+        std::vector<double> fitnesses_;
 
         using Gene = bool;
 
@@ -115,7 +121,9 @@ public:
             PopulationMutateType population_mutate_type,
             TrainType train_type,
             size_t max_generations,
-            size_t max_work_time): 
+            size_t max_work_time,
+            uint64_t seed = 0,
+            std::shared_ptr<const CancellationToken> cancellation = nullptr): 
             
             max_weight_(knapsack_problem.knapsack_capacity_),
             items_(knapsack_problem.items_),
@@ -127,7 +135,8 @@ public:
             population_mutate_type_(population_mutate_type),
             train_type_(train_type),
             max_work_time_(max_work_time),
-            start_time_(std::chrono::steady_clock::now()) {}
+            deadline_(cancellation),
+            random_(seed) {}
 
         void clear()
         {
@@ -164,21 +173,18 @@ public:
 
         void mutate(Chromosome& chromosome, bool reset = false) 
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<> dis(0., 1.);
+            if (reset)
+            {
+                std::fill(chromosome.genes.begin(), chromosome.genes.end(), false);
+            }
+            random_.forEachSuccess(chromosome.genes.size(), mutation_rate_, [&chromosome](size_t i)
+            {
+                chromosome.genes[i] = !chromosome.genes[i];
+            });
             chromosome.fitness = 0.;
             int w = 0;
             for (int i = 0; i < chromosome.genes.size(); i++) 
             {
-                if (reset)
-                {
-                    chromosome.genes[i] = false;
-                }
-                if (dis(gen) <= mutation_rate_) 
-                {
-                    chromosome.genes[i] = !chromosome.genes[i];
-                }
                 if (chromosome.genes[i])
                 {
                     chromosome.fitness += items_[i].value_;
@@ -194,14 +200,12 @@ public:
 
         void randChromosome(Chromosome& chromosome)
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
             std::uniform_int_distribution<> res(0, 1);
             chromosome.fitness = 0.;
             int w = 0;
             for (size_t i = 0; i < chromosome.genes.size(); ++i)
             {
-                chromosome.genes[i] = res(gen);
+                chromosome.genes[i] = res(random_);
                 if (chromosome.genes[i])
                 {
                     w += items_[i].weight_;
@@ -218,8 +222,6 @@ public:
         Population createPopulation() 
         {
             Population population(population_size_, items_.size());
-            std::random_device rd;
-            std::mt19937 gen(rd());
             if (start_population_type_ == StartPopulationType::MUTATE_POPULATION)
             {
                 for (size_t i = 0; i < population_size_; i++) 
@@ -272,9 +274,7 @@ public:
 
         std::pair<Chromosome, Chromosome> crossover(const Chromosome& parent1, const Chromosome& parent2) 
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            int sep = std::uniform_int_distribution<>(0, items_.size() - 2)(gen);
+            int sep = std::uniform_int_distribution<>(0, items_.size() - 2)(random_);
             Chromosome child1(items_.size()), child2(items_.size());
             int w1 = 0, w2 = 0;
             for (int i = 0; i < items_.size(); ++i) 
@@ -318,12 +318,10 @@ public:
 
         void selection(Population& population, size_t res_population_size) 
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
 
             if (population.sum_fitnesses == 0)
             {
-                std::shuffle(population.chromosomes.begin(), population.chromosomes.end(), gen);
+                std::shuffle(population.chromosomes.begin(), population.chromosomes.end(), random_);
                 if (population.chromosomes.size() > res_population_size)
                 {
                     population.chromosomes.resize(res_population_size);
@@ -341,22 +339,17 @@ public:
                 return;
             }
 
-            std::vector<double> probability(population.chromosomes.size());
-            std::uniform_real_distribution<double> prob(0., population.sum_fitnesses);
-
             Population res_population;
-            std::sort(population.chromosomes.begin(), population.chromosomes.end(), [](Chromosome& a, Chromosome& b){return a.fitness > b.fitness;});
-
-            probability[0] = population.chromosomes[0].fitness;
-            for (size_t i = 1; i < population.chromosomes.size(); ++i)
+            fitnesses_.resize(population.chromosomes.size());
+            for (size_t i = 0; i < population.chromosomes.size(); ++i)
             {
-                probability[i] = probability[i - 1] + population.chromosomes[i].fitness;
+                fitnesses_[i] = population.chromosomes[i].fitness;
             }
-            
+            alias_table_.assign(fitnesses_.begin(), fitnesses_.end());
+
             for (size_t i = 0; i < res_population_size * (1. - new_rundom_chromosome_coef_); ++i)
             {
-                double genp = prob(gen);
-                int tmp = std::lower_bound(probability.begin(), probability.end(), genp) - probability.begin();
+                size_t tmp = alias_table_(random_);
                 res_population.chromosomes.emplace_back(population.chromosomes[tmp]);
                 res_population.max_fitness = std::max(res_population.max_fitness, population.chromosomes[tmp].fitness);
                 res_population.sum_fitnesses += population.chromosomes[tmp].fitness;
@@ -385,8 +378,6 @@ public:
 
         void fixture(Population& population, size_t max_generations)
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
 
             double local_max_fit = population.max_fitness;
             int count = 0;
@@ -399,7 +390,7 @@ public:
 
                 size_t start_population_size = population.chromosomes.size();
 
-                std::shuffle(population.chromosomes.begin(), population.chromosomes.end(), gen);
+                std::shuffle(population.chromosomes.begin(), population.chromosomes.end(), random_);
                 for (size_t i = 0; i < start_population_size - 1; i += 2)
                 {
                     auto[ch1, ch2] = crossover(population.chromosomes[i], population.chromosomes[i + 1]);
@@ -449,7 +440,7 @@ public:
                     << "Max res: " << std::setw(10) << std::left << max_fit << '\n';
                 #endif
             }
-            while (count < max_generations && _WORKTIME_(start_time_) < max_work_time_);
+            while (count < max_generations && !deadline_.isCancelled());
 
             #ifdef KNAPSACK_TEST
                 _POPULATION_DUMP_("");
@@ -468,7 +459,7 @@ public:
 
         void evolutionMultiplePopulations()
         {
-            while(_WORKTIME_(start_time_) < max_work_time_)
+            while(!deadline_.isCancelled())
             {
                 Population population = createPopulation();
                 fixture(population, max_generations_);
@@ -480,7 +471,7 @@ public:
             Population population = createPopulation();
             fixture(population, max_generations_);
 
-            while(_WORKTIME_(start_time_) < max_work_time_) 
+            while(!deadline_.isCancelled()) 
             {
                 if (population.chromosomes.size() > population_size_)
                 {
@@ -497,7 +488,7 @@ public:
 
         double genetic_algorithm() 
         {
-            start_time_ = std::chrono::steady_clock::now();
+            deadline_.setTimeout(std::chrono::seconds(max_work_time_));
             max_fit = 0.;
             if (train_type_ == TrainType::EVOLUTION_MULTIPLE_POPULATIONS)
             {
@@ -557,16 +548,14 @@ public:
             return bound;
         }
 
-        double solve(size_t n, size_t W, const std::vector<long long>& p, const std::vector<long long>& w, size_t max_work_time) 
+        double solve(size_t n, size_t W, const std::vector<long long>& p, const std::vector<long long>& w, const CancellationToken& deadline) 
         {
             std::priority_queue<Node> Q;
             Node u, v;
             Q.push({-1, 0, 0, 0});
             double maxprofit = 0.;
 
-            auto start = std::chrono::steady_clock::now();
-
-            while (!Q.empty() && _WORKTIME_(start) < max_work_time) 
+            while (!Q.empty() && !deadline.isCancelled()) 
             {
                 u = Q.top();
                 Q.pop();
@@ -605,7 +594,8 @@ public:
         }
     };
 
-    static double dynamicProgrammingMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10)
+    static double dynamicProgrammingMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10,
+                                           std::shared_ptr<const CancellationToken> cancellation = nullptr)
     {
         #ifdef BENCHMARK
             _START_BENCHMARK_;
@@ -613,7 +603,7 @@ public:
 
         std::vector<std::vector<double>> dp(knapsack_problem.size_ + 1, std::vector<double>(knapsack_problem.knapsack_capacity_ + 1));
 
-        auto start = std::chrono::steady_clock::now();
+        CancellationToken deadline(std::chrono::seconds(max_work_time), cancellation);
         double ans = 0.;
 
         for (int i = 0; i <= knapsack_problem.size_; i++) 
@@ -635,7 +625,7 @@ public:
                     dp[i][j] = dp[i - 1][j];
                 }
                 ans = std::max(ans, dp[i][j]);
-                if (_WORKTIME_(start) >= max_work_time)
+                if (deadline.isCancelled())
                 {
                     return ans;
                 }
@@ -645,7 +635,8 @@ public:
         return ans;
     }
 
-    static double branchAndBoundaryMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10) 
+    static double branchAndBoundaryMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10,
+                                          std::shared_ptr<const CancellationToken> cancellation = nullptr) 
     {
 
         #ifdef BENCHMARK
@@ -663,7 +654,8 @@ public:
 
         BranchAndBoundaryMethod res;
 
-        return res.solve(knapsack_problem.size_, knapsack_problem.knapsack_capacity_, v, w, max_work_time);
+        CancellationToken deadline(std::chrono::seconds(max_work_time), cancellation);
+        return res.solve(knapsack_problem.size_, knapsack_problem.knapsack_capacity_, v, w, deadline);
     }
 
     static double geneticMethod(
@@ -676,7 +668,9 @@ public:
         GeneticMethod::TrainType train_type,
         size_t max_generations,
         size_t max_work_time,
-        size_t num_runs = 1)
+        size_t num_runs = 1,
+        uint64_t seed = 0,
+        std::shared_ptr<const CancellationToken> cancellation = nullptr)
     {
 
         #ifdef BENCHMARK
@@ -692,11 +686,13 @@ public:
             population_mutate_type,
             train_type,
             max_generations,
-            max_work_time);
+            max_work_time,
+            seed,
+            cancellation);
 
         double res = 0.;
 
-        for (size_t i = 0; i < num_runs; ++i)
+        for (size_t i = 0; i < num_runs && !(cancellation && cancellation->isCancelled()); ++i)
         {
             res = std::max(res, gen.genetic_algorithm());
         }
@@ -704,13 +700,14 @@ public:
         return res;
     }
 
-    static double greedyMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10)
+    static double greedyMethod(const KnapsackProblem& knapsack_problem, size_t max_work_time = 10,
+                               std::shared_ptr<const CancellationToken> cancellation = nullptr)
     {
         #ifdef BENCHMARK
             _START_BENCHMARK_;
         #endif
 
-        auto start = std::chrono::steady_clock::now();
+        CancellationToken deadline(std::chrono::seconds(max_work_time), cancellation);
 
         std::vector<KnapsackProblem::Item> items = knapsack_problem.items_;
 
@@ -721,7 +718,7 @@ public:
         long long v = 0.;
         long long best_v = 0.;
 
-        for (size_t i = 0; i < knapsack_problem.size_ && _WORKTIME_(start) < max_work_time; ++i)
+        for (size_t i = 0; i < knapsack_problem.size_ && !deadline.isCancelled(); ++i)
         {
             while(w + knapsack_problem.items_[i].weight_ > knapsack_problem.knapsack_capacity_)
             {
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        namespace Types
+        {
+            inline size_t popcount(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_popcountll(word);
+#else
+                word = word - ((word >> 1) & 0x5555555555555555ULL);
+                word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+                word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+                return (word * 0x0101010101010101ULL) >> 56;
+#endif
+            }
+
+            inline size_t countr_zero(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_ctzll(word);
+#else
+                size_t res = 0;
+                while (!(word & 1ULL)) { word >>= 1; ++res; }
+                return res;
+#endif
+            }
+
+            // Bit-packed gene storage used by Chromosome<bool, FitnessType>.
+            // Bits past size() in the last word are kept zero by every member function.
+            class BitGenes
+            {
+            public:
+                using Word_ = uint64_t;
+                using Words_ = std::vector<Word_>;
+
+                using value_type = bool;
+                using size_type = size_t;
+                using allocator_type = typename Words_::allocator_type;
+                using const_reference = bool;
+
+                static constexpr size_t word_bits = 64;
+
+                class reference
+                {
+                public:
+                    reference(Word_ *word, Word_ mask) : word_(word), mask_(mask) {}
+
+                    operator bool() const { return (*word_ & mask_) != 0; }
+                    bool operator~() const { return !bool(*this); }
+
+                    reference &operator=(bool value)
+                    {
+                        if (value) { *word_ |= mask_; }
+                        else { *word_ &= ~mask_; }
+                        return *this;
+                    }
+                    reference &operator=(const reference &other) { return *this = bool(other); }
+
+                    void flip() { *word_ ^= mask_; }
+
+                protected:
+                    Word_ *word_;
+                    Word_ mask_;
+                };
+
+                template <class Genes, class Reference>
+                class basic_iterator
+                {
+                public:
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = bool;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = Reference;
+
+                    basic_iterator(Genes *genes, size_t ind) : genes_(genes), ind_(ind) {}
+
+                    Reference operator*() const { return (*genes_)[ind_]; }
+                    Reference operator[](difference_type shift) const { return (*genes_)[ind_ + shift]; }
+
+                    basic_iterator &operator++() { ++ind_; return *this; }
+                    basic_iterator operator++(int) { basic_iterator res = *this; ++ind_; return res; }
+                    basic_iterator &operator--() { --ind_; return *this; }
+                    basic_iterator operator--(int) { basic_iterator res = *this; --ind_; return res; }
+                    basic_iterator &operator+=(difference_type shift) { ind_ += shift; return *this; }
+                    basic_iterator &operator-=(difference_type shift) { ind_ -= shift; return *this; }
+                    basic_iterator operator+(difference_type shift) const { return basic_iterator(genes_, ind_ + shift); }
+                    basic_iterator operator-(difference_type shift) const { return basic_iterator(genes_, ind_ - shift); }
+                    difference_type operator-(const basic_iterator &other) const { return difference_type(ind_) - difference_type(other.ind_); }
+
+                    bool operator==(const basic_iterator &other) const { return ind_ == other.ind_; }
+                    bool operator!=(const basic_iterator &other) const { return ind_ != other.ind_; }
+                    bool operator<(const basic_iterator &other) const { return ind_ < other.ind_; }
+
+                protected:
+                    Genes *genes_;
+                    size_t ind_;
+                };
+
+                using iterator = basic_iterator<BitGenes, reference>;
+                using const_iterator = basic_iterator<const BitGenes, bool>;
+
+                BitGenes() : size_(0) {}
+                BitGenes(const allocator_type &__a) : size_(0), words_(__a) {}
+                BitGenes(size_type __n) : size_(__n), words_(num_words_(__n)) {}
+                BitGenes(size_type __n, const allocator_type &__a) : size_(__n), words_(num_words_(__n), __a) {}
+                BitGenes(size_type __n, const bool &__x) : size_(__n), words_(num_words_(__n), __x ? ~Word_(0) : Word_(0)) { clear_tail_(); }
+                BitGenes(size_type __n, const bool &__x, const allocator_type &__a) : size_(__n), words_(num_words_(__n), __x ? ~Word_(0) : Word_(0), __a) { clear_tail_(); }
+                template <class _Iterator, class = std::enable_if_t<!std::is_integral<_Iterator>::value>>
+                BitGenes(_Iterator __first, _Iterator __last) : size_(0) { assign_(__first, __last); }
+                template <class _Iterator, class = std::enable_if_t<!std::is_integral<_Iterator>::value>>
+                BitGenes(_Iterator __first, _Iterator __last, const allocator_type &__a) : size_(0), words_(__a) { assign_(__first, __last); }
+                BitGenes(std::initializer_list<bool> __il) : size_(0) { assign_(__il.begin(), __il.end()); }
+                BitGenes(std::initializer_list<bool> __il, const allocator_type &__a) : size_(0), words_(__a) { assign_(__il.begin(), __il.end()); }
+                BitGenes(const std::vector<bool> &genes) : size_(0) { assign_(genes.begin(), genes.end()); }
+
+                BitGenes(const BitGenes &) = default;
+                BitGenes(BitGenes &&) = default;
+                BitGenes &operator=(const BitGenes &) = default;
+                BitGenes &operator=(BitGenes &&) = default;
+                BitGenes &operator=(std::initializer_list<bool> __il)
+                {
+                    assign_(__il.begin(), __il.end());
+                    return *this;
+                }
+
+                reference operator[](size_t ind) { return reference(&words_[ind / word_bits], Word_(1) << (ind % word_bits)); }
+                bool operator[](size_t ind) const { return (words_[ind / word_bits] >> (ind % word_bits)) & 1; }
+
+                reference at(size_t ind)
+                {
+                    if (ind >= size_) {std::__throw_out_of_range("BitGenes");}
+                    return (*this)[ind];
+                }
+                bool at(size_t ind) const
+                {
+                    if (ind >= size_) {std::__throw_out_of_range("BitGenes");}
+                    return (*this)[ind];
+                }
+
+                bool test(size_t ind) const { return (*this)[ind]; }
+                void set(size_t ind, bool value = true) { (*this)[ind] = value; }
+                void flip(size_t ind) { words_[ind / word_bits] ^= Word_(1) << (ind % word_bits); }
+                void flip()
+                {
+                    for (Word_ &word : words_) { word = ~word; }
+                    clear_tail_();
+                }
+
+                void resize(size_t size, bool value = false)
+                {
+                    size_t old_size = size_;
+                    words_.resize(num_words_(size), value ? ~Word_(0) : Word_(0));
+                    size_ = size;
+                    if (value && old_size < size && old_size % word_bits)
+                    {
+                        words_[old_size / word_bits] |= ~Word_(0) << (old_size % word_bits);
+                    }
+                    clear_tail_();
+                }
+
+                void push_back(bool value)
+                {
+                    if (size_ % word_bits == 0) { words_.push_back(0); }
+                    ++size_;
+                    (*this)[size_ - 1] = value;
+                }
+
+                void clear() { size_ = 0; words_.clear(); }
+                void reserve(size_t size) { words_.reserve(num_words_(size)); }
+
+                size_t size() const { return size_; }
+                bool empty() const { return size_ == 0; }
+
+                iterator begin() { return iterator(this, 0); }
+                iterator end() { return iterator(this, size_); }
+                const_iterator begin() const { return const_iterator(this, 0); }
+                const_iterator end() const { return const_iterator(this, size_); }
+                const_iterator cbegin() const { return begin(); }
+                const_iterator cend() const { return end(); }
+
+                // Raw word access. Writers must keep the bits past size() zero (see tailMask()).
+                Word_ *data() { return words_.data(); }
+                const Word_ *data() const { return words_.data(); }
+                size_t numWords() const { return words_.size(); }
+                Word_ tailMask() const { return size_ % word_bits ? (Word_(1) << (size_ % word_bits)) - 1 : ~Word_(0); }
+
+                size_t count() const
+                {
+                    size_t res = 0;
+                    for (Word_ word : words_) { res += popcount(word); }
+                    return res;
+                }
+
+                size_t countAnd(const BitGenes &other) const
+                {
+                    size_t res = 0;
+                    for (size_t i = 0; i < words_.size() && i < other.words_.size(); ++i) { res += popcount(words_[i] & other.words_[i]); }
+                    return res;
+                }
+
+                size_t hammingDistance(const BitGenes &other) const
+                {
+                    if (size_ != other.size_) {std::__throw_logic_error("BitGenes sizes differ");}
+                    size_t res = 0;
+                    for (size_t i = 0; i < words_.size(); ++i) { res += popcount(words_[i] ^ other.words_[i]); }
+                    return res;
+                }
+
+                template <class Function>
+                void forEachSetBit(Function &&fun) const
+                {
+                    for (size_t i = 0; i < words_.size(); ++i)
+                    {
+                        for (Word_ word = words_[i]; word; word &= word - 1)
+                        {
+                            fun(i * word_bits + countr_zero(word));
+                        }
+                    }
+                }
+
+                // Copies genes [begin, end) from other, a word at a time.
+                void assignRange(const BitGenes &other, size_t begin, size_t end)
+                {
+                    if (other.size_ != size_ || begin > end || end > size_) {std::__throw_logic_error("invalid BitGenes range");}
+                    if (begin == end)
+                    {
+                        return;
+                    }
+                    size_t first_word = begin / word_bits, last_word = (end - 1) / word_bits;
+                    Word_ first_mask = ~Word_(0) << (begin % word_bits);
+                    Word_ last_mask = ~Word_(0) >> (word_bits - 1 - (end - 1) % word_bits);
+                    if (first_word == last_word)
+                    {
+                        blendWord_(first_word, other.words_[first_word], first_mask & last_mask);
+                        return;
+                    }
+                    blendWord_(first_word, other.words_[first_word], first_mask);
+                    for (size_t i = first_word + 1; i < last_word; ++i)
+                    {
+                        words_[i] = other.words_[i];
+                    }
+                    blendWord_(last_word, other.words_[last_word], last_mask);
+                }
+
+                // Takes the genes of other wherever mask has a set bit.
+                void assignMasked(const BitGenes &other, const Word_ *mask)
+                {
+                    if (other.size_ != size_) {std::__throw_logic_error("BitGenes sizes differ");}
+                    for (size_t i = 0; i < words_.size(); ++i)
+                    {
+                        blendWord_(i, other.words_[i], mask[i]);
+                    }
+                    clear_tail_();
+                }
+
+                size_t hash() const
+                {
+                    uint64_t res = 0x9e3779b97f4a7c15ULL ^ size_;
+                    for (Word_ word : words_)
+                    {
+                        res ^= word + 0x9e3779b97f4a7c15ULL + (res << 6) + (res >> 2);
+                        res *= 0xff51afd7ed558ccdULL;
+                        res ^= res >> 32;
+                    }
+                    return res;
+                }
+
+                bool operator==(const BitGenes &other) const { return size_ == other.size_ && words_ == other.words_; }
+                bool operator!=(const BitGenes &other) const { return !(*this == other); }
+
+            protected:
+                static size_t num_words_(size_t size) { return (size + word_bits - 1) / word_bits; }
+
+                void clear_tail_()
+                {
+                    if (!words_.empty())
+                    {
+                        words_.back() &= tailMask();
+                    }
+                }
+
+                void blendWord_(size_t ind, Word_ other, Word_ mask) { words_[ind] = (words_[ind] & ~mask) | (other & mask); }
+
+                template <class _Iterator>
+                void assign_(_Iterator __first, _Iterator __last)
+                {
+                    clear();
+                    for (; __first != __last; ++__first)
+                    {
+                        push_back(bool(*__first));
+                    }
+                }
+
+                size_t size_;
+                Words_ words_;
+            };
+        } // end namespace Types
+    } // end namespace GeneticAlgorithm
+} // end namespace HeuristicAlgorithm
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "interfaces.hpp"
+#include "types.hpp"
+#include "bit_genes.hpp"
+#include "../tools/random.hpp"
+#include "../tools/mapped_file.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+        using namespace Interfaces;
+
+        // Binary snapshot of a population: every slot of the generation suffix with its ring position,
+        // genes and fitness of every chromosome and optionally the generator state.
+        // Native byte order, meant to be read back on the same platform.
+        template <class GeneType, class FitnessType>
+        struct Checkpoint
+        {
+            static_assert(std::is_trivially_copyable<GeneType>::value, "checkpoint needs trivially copyable genes");
+            static_assert(std::is_trivially_copyable<FitnessType>::value, "checkpoint needs trivially copyable fitness");
+
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+            using Generations_ = typename Population_::Generations_;
+            using Genes_ = typename Chromosome_::Genes_;
+
+            // The file is written next to path and renamed over it, so an interrupted save keeps the previous checkpoint.
+            // std::filesystem::rename replaces an existing path on every platform (std::rename fails on Windows then).
+            static void save(const std::string& path, const Population_& population, const Tools::Random* random = nullptr)
+            {
+                const Generations_& generations = population.get();
+                Header_ header = {magic_, version_, sizeof(GeneType), sizeof(FitnessType), random != nullptr,
+                                  generations.capacity(), generations.size(), generations.start(), {}};
+                if (random)
+                {
+                    header.random_state = random->getState();
+                }
+
+                std::string tmp_path = path + ".tmp";
+                {
+                    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                    if (!out)
+                    {
+                        std::__throw_runtime_error(("cannot open \"" + tmp_path + "\"").c_str());
+                    }
+                    write_(out, &header, sizeof(header));
+                    const char no_fitness[sizeof(FitnessType)] = {};
+                    for (const Generation_& generation: generations.data())
+                    {
+                        write_value_(out, uint64_t(generation.get().size()));
+                        for (const Chromosome_& chromosome: generation.get())
+                        {
+                            const auto& fitness = chromosome.getFitness();
+                            write_value_(out, uint64_t(chromosome.cget().size()));
+                            write_value_(out, uint64_t(fitness.has_value()));
+                            write_(out, fitness.has_value() ? static_cast<const void*>(&*fitness) : no_fitness, sizeof(FitnessType));
+                            write_(out, genes_data_(chromosome.cget()), genes_bytes_(chromosome.cget().size()));
+                        }
+                    }
+                    out.flush();
+                    if (!out)
+                    {
+                        std::__throw_runtime_error(("cannot write \"" + tmp_path + "\"").c_str());
+                    }
+                }
+                std::error_code error;
+                std::filesystem::rename(tmp_path, path, error);
+                if (error)
+                {
+                    std::__throw_runtime_error(("cannot replace \"" + path + "\"").c_str());
+                }
+            }
+
+            // Restores the population and, if both are present, the generator state.
+            static Population_ load(const std::string& path, Tools::Random* random = nullptr)
+            {
+                Tools::MappedFile file(path);
+                Reader_ reader{file.data(), file.data() + file.size()};
+
+                Header_ header;
+                reader.read(&header, sizeof(header));
+                if (header.magic != magic_ || header.version != version_)
+                {
+                    std::__throw_runtime_error(("\"" + path + "\" is not a population checkpoint").c_str());
+                }
+                if (header.gene_size != sizeof(GeneType) || header.fitness_size != sizeof(FitnessType))
+                {
+                    std::__throw_runtime_error(("\"" + path + "\" has other gene or fitness types").c_str());
+                }
+
+                reader.checkCount(header.capacity, sizeof(uint64_t));
+                typename Generations_::SuffixData_ slots(header.capacity);
+                for (Generation_& generation: slots)
+                {
+                    uint64_t num_chromosomes = reader.template get<uint64_t>();
+                    reader.checkCount(num_chromosomes, 2 * sizeof(uint64_t) + sizeof(FitnessType));
+                    generation.get().resize(num_chromosomes);
+                    for (Chromosome_& chromosome: generation.get())
+                    {
+                        uint64_t num_genes = reader.template get<uint64_t>();
+                        bool has_fitness = reader.template get<uint64_t>();
+                        FitnessType fitness = reader.template get<FitnessType>();
+                        reader.checkCount(genes_bytes_(num_genes), 1);
+                        Genes_ genes(num_genes);
+                        reader.read(genes_data_(genes), genes_bytes_(num_genes));
+                        clear_tail_(genes);
+                        chromosome = std::move(genes);
+                        if (has_fitness)
+                        {
+                            chromosome.getFitness() = fitness;
+                        }
+                    }
+                }
+                if (reader.cur != reader.end)
+                {
+                    std::__throw_runtime_error(("\"" + path + "\" has trailing data").c_str());
+                }
+
+                if (random && header.has_random)
+                {
+                    random->setState(header.random_state);
+                }
+                Population_ population;
+                population.get() = Generations_(std::move(slots), header.capacity, header.start, header.size);
+                return population;
+            }
+
+        protected:
+            static constexpr uint64_t magic_ = 0x54504b4341474148ULL; // "HAGACKPT"
+            static constexpr uint64_t version_ = 1;
+
+            struct Header_
+            {
+                uint64_t magic;
+                uint64_t version;
+                uint64_t gene_size;
+                uint64_t fitness_size;
+                uint64_t has_random;
+                uint64_t capacity;
+                uint64_t size;
+                uint64_t start;
+                Tools::Random::State random_state;
+            };
+
+            struct Reader_
+            {
+                const char* cur;
+                const char* end;
+
+                void read(void* dst, size_t num_bytes)
+                {
+                    if (size_t(end - cur) < num_bytes)
+                    {
+                        std::__throw_runtime_error("truncated checkpoint");
+                    }
+                    std::memcpy(dst, cur, num_bytes);
+                    cur += num_bytes;
+                }
+
+                template <class Type>
+                Type get()
+                {
+                    Type value;
+                    read(&value, sizeof(Type));
+                    return value;
+                }
+
+                // Rejects counts that could not fit into the rest of the file before allocating for them.
+                void checkCount(uint64_t count, size_t min_bytes) const
+                {
+                    if (count > size_t(end - cur) / min_bytes)
+                    {
+                        std::__throw_runtime_error("corrupted checkpoint");
+                    }
+                }
+            };
+
+            static void write_(std::ofstream& out, const void* src, size_t num_bytes)
+            {
+                out.write(static_cast<const char*>(src), num_bytes);
+            }
+
+            template <class Type>
+            static void write_value_(std::ofstream& out, const Type& value)
+            {
+                write_(out, &value, sizeof(Type));
+            }
+
+            static size_t genes_bytes_(size_t num_genes)
+            {
+                if constexpr (std::is_same<Genes_, BitGenes>::value)
+                {
+                    return (num_genes + BitGenes::word_bits - 1) / BitGenes::word_bits * sizeof(BitGenes::Word_);
+                }
+                else
+                {
+                    return num_genes * sizeof(GeneType);
+                }
+            }
+
+            // Bits past size() of a foreign or corrupted file would break popcount, equality and hashing of BitGenes.
+            static void clear_tail_(Genes_& genes)
+            {
+                if constexpr (std::is_same<Genes_, BitGenes>::value)
+                {
+                    if (genes.size() != 0)
+                    {
+                        genes.data()[(genes.size() - 1) / BitGenes::word_bits] &= genes.tailMask();
+                    }
+                }
+            }
+
+            static const void* genes_data_(const Genes_& genes) { return genes.data(); }
+            static void* genes_data_(Genes_& genes) { return genes.data(); }
+        };
+
+        // AnyFunction writing a checkpoint every interval calls, after the optional next AnyFunction.
+        template <class GeneType, class FitnessType>
+        struct CheckpointAnyFunction: public AnyFunctionWrapper<GeneType, FitnessType>
+        {
+            using Population_ = Population<GeneType, FitnessType>;
+            using AnyFunction_ = AnyFunctionWrapper<GeneType, FitnessType>;
+
+            CheckpointAnyFunction(std::string path, size_t interval = 1, std::shared_ptr<Tools::Random> random = nullptr,
+                                  std::shared_ptr<AnyFunction_> next = nullptr):
+                path_(std::move(path)), interval_(interval), random_(random), next_(next)
+            {
+                if (interval_ == 0) {std::__throw_logic_error("checkpoint interval must be greater than 0");}
+            }
+
+            void operator()(Population_& population) override
+            {
+                if (next_)
+                {
+                    (*next_)(population);
+                }
+                if (++num_calls_ % interval_ == 0)
+                {
+                    Checkpoint<GeneType, FitnessType>::save(path_, population, random_.get());
+                }
+            }
+
+        protected:
+            std::string path_;
+            size_t interval_;
+            size_t num_calls_ = 0;
+            std::shared_ptr<Tools::Random> random_;
+            std::shared_ptr<AnyFunction_> next_;
+        };
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "types.hpp"
+#include "../tools/span.hpp"
+
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        namespace Types
+        {
+            template <class FitnessType, bool is_const>
+            class FitnessReference
+            {
+            public:
+                using Fitness_ = std::conditional_t<is_const, const FitnessType, FitnessType>;
+                using Flag_ = std::conditional_t<is_const, const unsigned char, unsigned char>;
+
+                FitnessReference(Fitness_ *fitness, Flag_ *has_fitness) : fitness_(fitness), has_fitness_(has_fitness) {}
+
+                bool has_value() const { return *has_fitness_; }
+                explicit operator bool() const { return has_value(); }
+
+                const FitnessType &value() const
+                {
+                    if (!has_value()) {std::__throw_logic_error("fitness is not calculated");}
+                    return *fitness_;
+                }
+                const FitnessType &operator*() const { return *fitness_; }
+
+                operator std::optional<FitnessType>() const { return has_value() ? std::optional<FitnessType>(*fitness_) : std::nullopt; }
+
+                template <bool c = is_const, class = std::enable_if_t<!c>>
+                FitnessReference &operator=(const FitnessType &fitness)
+                {
+                    *fitness_ = fitness;
+                    *has_fitness_ = 1;
+                    return *this;
+                }
+                template <bool c = is_const, class = std::enable_if_t<!c>>
+                FitnessReference &operator=(const std::optional<FitnessType> &fitness)
+                {
+                    if (fitness.has_value()) { *fitness_ = *fitness; }
+                    *has_fitness_ = fitness.has_value();
+                    return *this;
+                }
+                template <bool c = is_const, class = std::enable_if_t<!c>>
+                void reset() { *has_fitness_ = 0; }
+
+                template <bool other_const>
+                bool operator<(const FitnessReference<FitnessType, other_const> &other) const { return std::optional<FitnessType>(*this) < std::optional<FitnessType>(other); }
+                template <bool other_const>
+                bool operator>(const FitnessReference<FitnessType, other_const> &other) const { return std::optional<FitnessType>(*this) > std::optional<FitnessType>(other); }
+                template <bool other_const>
+                bool operator==(const FitnessReference<FitnessType, other_const> &other) const { return std::optional<FitnessType>(*this) == std::optional<FitnessType>(other); }
+
+            protected:
+                Fitness_ *fitness_;
+                Flag_ *has_fitness_;
+            };
+
+            // Chromosome stored as a row of DenseGeneration. Accessors are named as in Chromosome,
+            // but get()/cget() return a Tools::Span over the row instead of the gene container.
+            template <class GeneType, class FitnessType, bool is_const>
+            class ChromosomeView
+            {
+            public:
+                using Gene_ = std::conditional_t<is_const, const GeneType, GeneType>;
+                using Fitness_ = std::conditional_t<is_const, const FitnessType, FitnessType>;
+                using Flag_ = std::conditional_t<is_const, const unsigned char, unsigned char>;
+
+                ChromosomeView(Gene_ *genes, size_t num_genes, Fitness_ *fitness, Flag_ *has_fitness) :
+                    genes_(genes), num_genes_(num_genes), fitness_(fitness), has_fitness_(has_fitness) {}
+
+                template <bool c = is_const, class = std::enable_if_t<!c>>
+                Tools::Span<GeneType> get()
+                {
+                    *has_fitness_ = 0;
+                    return Tools::Span<GeneType>(genes_, num_genes_);
+                }
+                Tools::Span<const GeneType> get() const { return cget(); }
+                Tools::Span<const GeneType> cget() const { return Tools::Span<const GeneType>(genes_, num_genes_); }
+
+                FitnessReference<FitnessType, is_const> getFitness() { return FitnessReference<FitnessType, is_const>(fitness_, has_fitness_); }
+                FitnessReference<FitnessType, true> getFitness() const { return FitnessReference<FitnessType, true>(fitness_, has_fitness_); }
+
+                Chromosome<GeneType, FitnessType> toChromosome() const
+                {
+                    Chromosome<GeneType, FitnessType> res(genes_, genes_ + num_genes_);
+                    res.getFitness() = std::optional<FitnessType>(getFitness());
+                    return res;
+                }
+
+            protected:
+                Gene_ *genes_;
+                size_t num_genes_;
+                Fitness_ *fitness_;
+                Flag_ *has_fitness_;
+            };
+
+            // Fitness values and has-value flags of a generation gathered into two dense arrays, genes are not copied.
+            template <class FitnessType>
+            class DenseFitness
+            {
+            public:
+                template <class GeneType>
+                void assign(const Generation<GeneType, FitnessType> &generation)
+                {
+                    size_t num_chromosomes = generation.get().size();
+                    fitness_.resize(num_chromosomes);
+                    has_fitness_.resize(num_chromosomes);
+                    for (size_t i = 0; i < num_chromosomes; ++i)
+                    {
+                        const std::optional<FitnessType> &fitness = generation.get()[i].getFitness();
+                        has_fitness_[i] = fitness.has_value();
+                        if (fitness.has_value())
+                        {
+                            fitness_[i] = *fitness;
+                        }
+                    }
+                }
+
+                // Index of the best evaluated chromosome, a single linear pass over the fitness array.
+                template <class Compare = std::greater<FitnessType>>
+                std::optional<size_t> best(Compare compare = Compare()) const
+                {
+                    std::optional<size_t> res;
+                    for (size_t i = 0; i < fitness_.size(); ++i)
+                    {
+                        if (has_fitness_[i] && (!res || compare(fitness_[i], fitness_[*res])))
+                        {
+                            res = i;
+                        }
+                    }
+                    return res;
+                }
+
+                size_t size() const { return fitness_.size(); }
+                bool hasFitness(size_t ind) const { return has_fitness_[ind]; }
+
+                const std::vector<FitnessType> &fitness() const { return fitness_; }
+                const std::vector<unsigned char> &fitnessFlags() const { return has_fitness_; }
+
+            protected:
+                std::vector<FitnessType> fitness_;
+                std::vector<unsigned char> has_fitness_;
+            };
+
+            // Generation of equally sized chromosomes kept as one row-major gene matrix plus dense fitness arrays.
+            template <class GeneType, class FitnessType>
+            class DenseGeneration
+            {
+                static_assert(!std::is_same<GeneType, bool>::value, "bool genes are already bit-packed by Chromosome<bool, FitnessType>");
+
+            public:
+                using Chromosome_ = Chromosome<GeneType, FitnessType>;
+                using Generation_ = Generation<GeneType, FitnessType>;
+                using ChromosomeView_ = ChromosomeView<GeneType, FitnessType, false>;
+                using ConstChromosomeView_ = ChromosomeView<GeneType, FitnessType, true>;
+
+                DenseGeneration() : num_chromosomes_(0), num_genes_(0) {}
+                DenseGeneration(size_t num_chromosomes, size_t num_genes, const GeneType &gene = GeneType()) :
+                    num_chromosomes_(num_chromosomes),
+                    num_genes_(num_genes),
+                    genes_(num_chromosomes * num_genes, gene),
+                    fitness_(num_chromosomes),
+                    has_fitness_(num_chromosomes, 0) {}
+                DenseGeneration(const Generation_ &generation) : DenseGeneration() { assign(generation); }
+
+                void assign(const Generation_ &generation)
+                {
+                    size_t num_genes = generation.get().empty() ? 0 : generation.get()[0].cget().size();
+                    resize(generation.get().size(), num_genes);
+                    for (size_t i = 0; i < num_chromosomes_; ++i)
+                    {
+                        const Chromosome_ &chromosome = generation.get()[i];
+                        if (chromosome.cget().size() != num_genes_)
+                        {
+                            std::__throw_logic_error("chromosomes of a dense generation must have equal size");
+                        }
+                        std::copy(chromosome.cget().begin(), chromosome.cget().end(), genes_.begin() + i * num_genes_);
+                        (*this)[i].getFitness() = chromosome.getFitness();
+                    }
+                }
+
+                Generation_ toGeneration() const
+                {
+                    Generation_ res;
+                    res.get().reserve(num_chromosomes_);
+                    for (size_t i = 0; i < num_chromosomes_; ++i)
+                    {
+                        res.get().push_back((*this)[i].toChromosome());
+                    }
+                    return res;
+                }
+
+                void resize(size_t num_chromosomes, size_t num_genes)
+                {
+                    if (num_genes != num_genes_ && num_chromosomes_ != 0)
+                    {
+                        std::fill(has_fitness_.begin(), has_fitness_.end(), 0);
+                    }
+                    num_chromosomes_ = num_chromosomes;
+                    num_genes_ = num_genes;
+                    genes_.resize(num_chromosomes * num_genes);
+                    fitness_.resize(num_chromosomes);
+                    has_fitness_.resize(num_chromosomes, 0);
+                }
+
+                ChromosomeView_ operator[](size_t ind)
+                {
+                    return ChromosomeView_(genes_.data() + ind * num_genes_, num_genes_, fitness_.data() + ind, has_fitness_.data() + ind);
+                }
+                ConstChromosomeView_ operator[](size_t ind) const
+                {
+                    return ConstChromosomeView_(genes_.data() + ind * num_genes_, num_genes_, fitness_.data() + ind, has_fitness_.data() + ind);
+                }
+
+                void swap(size_t first, size_t second)
+                {
+                    if (first == second)
+                    {
+                        return;
+                    }
+                    std::swap_ranges(genes_.begin() + first * num_genes_, genes_.begin() + (first + 1) * num_genes_, genes_.begin() + second * num_genes_);
+                    std::swap(fitness_[first], fitness_[second]);
+                    std::swap(has_fitness_[first], has_fitness_[second]);
+                }
+
+                // Index of the best evaluated chromosome, a single linear pass over the fitness array.
+                template <class Compare = std::greater<FitnessType>>
+                std::optional<size_t> best(Compare compare = Compare()) const
+                {
+                    std::optional<size_t> res;
+                    for (size_t i = 0; i < num_chromosomes_; ++i)
+                    {
+                        if (has_fitness_[i] && (!res || compare(fitness_[i], fitness_[*res])))
+                        {
+                            res = i;
+                        }
+                    }
+                    return res;
+                }
+
+                size_t size() const { return num_chromosomes_; }
+                size_t numGenes() const { return num_genes_; }
+                bool hasFitness(size_t ind) const { return has_fitness_[ind]; }
+
+                std::vector<GeneType> &genes() { return genes_; }
+                const std::vector<GeneType> &genes() const { return genes_; }
+                std::vector<FitnessType> &fitness() { return fitness_; }
+                const std::vector<FitnessType> &fitness() const { return fitness_; }
+                const std::vector<unsigned char> &fitnessFlags() const { return has_fitness_; }
+
+            protected:
+                size_t num_chromosomes_;
+                size_t num_genes_;
+                std::vector<GeneType> genes_;
+                std::vector<FitnessType> fitness_;
+                std::vector<unsigned char> has_fitness_;
+            };
+        } // end namespace Types
+    } // end namespace GeneticAlgorithm
+} // end namespace HeuristicAlgorithm
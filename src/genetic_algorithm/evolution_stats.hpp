@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../tools/duration_stats.hpp"
+
+#include <array>
+#include <chrono>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        enum class Stage
+        {
+            crossingover,
+            mutation,
+            fitness,
+            selection,
+            log,
+            any_function,
+            migration,
+            // crossingover, mutation and fitness of the fused pipeline
+            fused,
+        };
+
+        constexpr size_t num_stages = 8;
+
+        inline const char* stageName(Stage stage)
+        {
+            static const char* const names[num_stages] = {"crossingover", "mutation", "fitness", "selection", "log", "any function", "migration", "fused"};
+            return names[static_cast<size_t>(stage)];
+        }
+
+        // Time spent in every stage of the evolution loop: the last generation and statistics over all timed generations.
+        struct EvolutionStats
+        {
+            using Duration = Tools::DurationStats::Duration;
+
+            const Tools::DurationStats& operator[](Stage stage) const { return stages[static_cast<size_t>(stage)]; }
+            Duration last(Stage stage) const { return last_stages[static_cast<size_t>(stage)]; }
+
+            void clear() { *this = EvolutionStats(); }
+
+            size_t num_generations = 0;
+            // whole generations, including the work between the stages
+            Tools::DurationStats generation;
+            Duration last_generation{ 0 };
+            std::array<Tools::DurationStats, num_stages> stages;
+            std::array<Duration, num_stages> last_stages = {};
+        };
+
+        // Times consecutive stages of one generation, a null stats pointer turns it into no-ops without clock reads.
+        class StageTimer
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            StageTimer(EvolutionStats* stats): stats_(stats)
+            {
+                if (stats_)
+                {
+                    start_ = last_ = Clock::now();
+                }
+            }
+
+            // Stage that ran since the previous call.
+            void stop(Stage stage)
+            {
+                if (!stats_)
+                {
+                    return;
+                }
+                Clock::time_point now = Clock::now();
+                EvolutionStats::Duration duration = std::chrono::duration_cast<EvolutionStats::Duration>(now - last_);
+                stats_->stages[static_cast<size_t>(stage)].add(duration);
+                stats_->last_stages[static_cast<size_t>(stage)] = duration;
+                last_ = now;
+            }
+
+            // Excludes the time since the previous call from every stage.
+            void skip()
+            {
+                if (stats_)
+                {
+                    last_ = Clock::now();
+                }
+            }
+
+            void finish()
+            {
+                if (!stats_)
+                {
+                    return;
+                }
+                EvolutionStats::Duration duration = std::chrono::duration_cast<EvolutionStats::Duration>(Clock::now() - start_);
+                stats_->generation.add(duration);
+                stats_->last_generation = duration;
+                ++stats_->num_generations;
+            }
+
+        protected:
+            EvolutionStats* stats_;
+            Clock::time_point start_;
+            Clock::time_point last_;
+        };
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <functional>
+#include <cstdint>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        namespace Types
+        {
+            template <class Genes>
+            struct GenesHash
+            {
+                size_t operator()(const Genes &genes) const
+                {
+                    using GeneType = typename Genes::value_type;
+                    std::hash<GeneType> gene_hash;
+                    uint64_t res = 0x9e3779b97f4a7c15ULL ^ genes.size();
+                    for (const auto &gene : genes)
+                    {
+                        res = mix_(res ^ gene_hash(gene));
+                    }
+                    return res;
+                }
+
+            protected:
+                static uint64_t mix_(uint64_t x)
+                {
+                    x ^= x >> 33;
+                    x *= 0xff51afd7ed558ccdULL;
+                    x ^= x >> 33;
+                    x *= 0xc4ceb9fe1a85ec53ULL;
+                    x ^= x >> 33;
+                    return x;
+                }
+            };
+
+            template <>
+            struct GenesHash<std::vector<bool>>
+            {
+                size_t operator()(const std::vector<bool> &genes) const { return std::hash<std::vector<bool>>()(genes); }
+            };
+
+            template <>
+            struct GenesHash<BitGenes>
+            {
+                size_t operator()(const BitGenes &genes) const { return genes.hash(); }
+            };
+
+            // Direct-mapped cache: a chromosome hashes into one slot, the slot is overwritten on collision.
+            // Lookups and inserts are serialized by a mutex, so workers of the fused pipeline can share it.
+            template <class GeneType, class FitnessType>
+            class FitnessCache
+            {
+            public:
+                using Chromosome_ = Chromosome<GeneType, FitnessType>;
+                using Genes_ = typename Chromosome_::Genes_;
+
+                FitnessCache(size_t capacity = 1 << 16)
+                {
+                    if (capacity == 0)
+                    {
+                        std::__throw_logic_error("capacity must be greater than 0");
+                    }
+                    size_t pow2 = 1;
+                    while (pow2 < capacity)
+                    {
+                        pow2 <<= 1;
+                    }
+                    slots_.resize(pow2);
+                    mask_ = pow2 - 1;
+                }
+
+                size_t hash(const Chromosome_ &chromosome) const { return GenesHash<Genes_>()(chromosome.cget()); }
+
+                std::optional<FitnessType> find(const Chromosome_ &chromosome, size_t hash)
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    const Slot &slot = slots_[hash & mask_];
+                    if (slot.fitness_.has_value() && slot.hash_ == hash && slot.genes_ == chromosome.cget())
+                    {
+                        hits_.fetch_add(1, std::memory_order_relaxed);
+                        return slot.fitness_;
+                    }
+                    misses_.fetch_add(1, std::memory_order_relaxed);
+                    return std::nullopt;
+                }
+                std::optional<FitnessType> find(const Chromosome_ &chromosome) { return find(chromosome, hash(chromosome)); }
+
+                void insert(const Chromosome_ &chromosome, size_t hash)
+                {
+                    if (!chromosome.getFitness().has_value())
+                    {
+                        return;
+                    }
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    Slot &slot = slots_[hash & mask_];
+                    slot.hash_ = hash;
+                    slot.genes_ = chromosome.cget();
+                    slot.fitness_ = chromosome.getFitness();
+                }
+                void insert(const Chromosome_ &chromosome) { insert(chromosome, hash(chromosome)); }
+
+                void clear()
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    for (Slot &slot : slots_)
+                    {
+                        slot.fitness_.reset();
+                    }
+                    hits_.store(0, std::memory_order_relaxed);
+                    misses_.store(0, std::memory_order_relaxed);
+                }
+
+                void resetCounters()
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    hits_.store(0, std::memory_order_relaxed);
+                    misses_.store(0, std::memory_order_relaxed);
+                }
+
+                // Safe to poll from other threads during a run.
+                size_t hits() const { return hits_.load(std::memory_order_relaxed); }
+                size_t misses() const { return misses_.load(std::memory_order_relaxed); }
+                size_t capacity() const { return slots_.size(); }
+
+            protected:
+                struct Slot
+                {
+                    size_t hash_ = 0;
+                    Genes_ genes_;
+                    std::optional<FitnessType> fitness_;
+                };
+
+                std::mutex mtx_;
+                std::vector<Slot> slots_;
+                size_t mask_;
+                // atomic, so the getters need not take the mutex held by concurrent lookups
+                std::atomic<size_t> hits_{ 0 };
+                std::atomic<size_t> misses_{ 0 };
+            };
+        } // end namespace Types
+    } // end namespace GeneticAlgorithm
+} // end namespace HeuristicAlgorithm
@@ -2,14 +2,22 @@
 
 #include "interfaces.hpp"
 #include "types.hpp"
+#include "fitness_cache.hpp"
+#include "evolution_stats.hpp"
+#include "population_snapshots.hpp"
 #include "../algorithm.hpp"
+#include "../tools/worker_pool.hpp"
+#include "../tools/random.hpp"
+#include "../tools/cancellation.hpp"
 
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include <optional>
 #include <stdexcept>
 #include <functional>
+#include <algorithm>
 
 namespace HeuristicAlgorithm
 {
@@ -24,33 +32,118 @@ namespace HeuristicAlgorithm
             using Chromosome_ = Chromosome<GeneType, FitnessType>;
             using Generation_ = Generation<GeneType, FitnessType>;
             using Population_ = Population<GeneType, FitnessType>;
+            using FitnessCache_ = FitnessCache<GeneType, FitnessType>;
+            using PopulationSnapshots_ = PopulationSnapshots<GeneType, FitnessType>;
 
             using FitnessFunction_ = FitnessFunctionWrapper<GeneType, FitnessType>;
+            using BatchFitnessFunction_ = BatchFitnessFunctionWrapper<GeneType, FitnessType>;
+            using IncrementalFitnessFunction_ = IncrementalFitnessFunctionWrapper<GeneType, FitnessType>;
             using Selection_ = SelectionWrapper<GeneType, FitnessType>;
             using Mutation_ = MutationWrapper<GeneType, FitnessType>;
             using Crossingover_ = CrossingoverWrapper<GeneType, FitnessType>;
+            using RecyclingCrossingover_ = RecyclingCrossingoverWrapper<GeneType, FitnessType>;
+            using ChromosomeMutation_ = ChromosomeMutationWrapper<GeneType, FitnessType>;
+            using ChromosomeCrossingover_ = ChromosomeCrossingoverWrapper<GeneType, FitnessType>;
             using ConditionsForStopping_ = ConditionsForStoppingWrapper<GeneType, FitnessType>;
             using AnyFunction_ = AnyFunctionWrapper<GeneType, FitnessType>;
+            using Migration_ = MigrationWrapper<GeneType, FitnessType>;
             
             using StartEvolutionLog_ = StartEvolutionLogWrapper<GeneType, FitnessType>;
             using EndEvolutionLog_ = EndEvolutionLogWrapper<GeneType, FitnessType>;
             using NewGenerationLog_ = NewGenerationLogWrapper<GeneType, FitnessType>;
+            using EvolutionStatsLog_ = EvolutionStatsLogWrapper<GeneType, FitnessType>;
 
             void setFitnessFunction(std::shared_ptr<FitnessFunction_> fun) { fitnessFunction_ = fun; }
+            void setBatchFitnessFunction(std::shared_ptr<BatchFitnessFunction_> fun) { batchFitnessFunction_ = fun; }
+            void setIncrementalFitnessFunction(std::shared_ptr<IncrementalFitnessFunction_> fun) { incrementalFitnessFunction_ = fun; }
             void setSelection(std::shared_ptr<Selection_> fun) { selection_ = fun; }
             void setMutation(std::shared_ptr<Mutation_> fun) { mutation_ = fun; }
             void setCrossingover(std::shared_ptr<Crossingover_> fun) { crossingover_ = fun; }
+            void setRecyclingCrossingover(std::shared_ptr<RecyclingCrossingover_> fun) { recyclingCrossingover_ = fun; }
+            void setChromosomeMutation(std::shared_ptr<ChromosomeMutation_> fun) { chromosomeMutation_ = fun; }
+            // num_offspring == 0 keeps the size of the last generation
+            void setChromosomeCrossingover(std::shared_ptr<ChromosomeCrossingover_> fun, size_t num_offspring = 0)
+            {
+                chromosomeCrossingover_ = fun;
+                num_offspring_ = num_offspring;
+            }
             void setConditionsForStopping(std::shared_ptr<ConditionsForStopping_> fun) { conditionsForStopping_ = fun; }
             void setAnyFunction(std::shared_ptr<AnyFunction_> fun) { anyFunction_ = fun; }
+            void setMigration(std::shared_ptr<Migration_> fun) { migration_ = fun; }
 
             void setStartEvolutionLog(std::shared_ptr<StartEvolutionLog_> fun) { startEvolutionLog_ = fun; }
             void setEndEvolutionLog(std::shared_ptr<EndEvolutionLog_> fun) { endEvolutionLog_ = fun; }
             void setNewGenerationLog(std::shared_ptr<NewGenerationLog_> fun) { newGenerationLog_ = fun; }
+            // Called after every generation with the stage timings, turns timing on.
+            void setEvolutionStatsLog(std::shared_ptr<EvolutionStatsLog_> fun)
+            {
+                evolutionStatsLog_ = fun;
+                is_timing_ = is_timing_ || fun;
+            }
+
+            void setParallel(bool is_parallel) { is_parallel_ = is_parallel; }
+            void setNumThreads(size_t num_threads) { num_threads_ = num_threads; workerPool_.reset(); }
+            void setChunkSize(size_t chunk_size) { chunk_size_ = chunk_size; }
+            void setWorkerPool(std::shared_ptr<Tools::WorkerPool> worker_pool) { workerPool_ = worker_pool; }
+
+            // The chromosome and recycling crossingovers build the offspring in the evicted storage,
+            // the result of a CrossingoverWrapper is copied into it (the operator still allocates its own result).
+            void setRecycling(bool is_recycling) { is_recycling_ = is_recycling; }
+            // Runs the chromosome crossingover, the chromosome mutation and the fitness of each offspring back to back,
+            // tile_size offspring at a time (a BatchFitnessFunction gets one tile per call).
+            // A MutationWrapper works on the whole generation and cannot be fused: evolution() rejects the combination.
+            void setFused(bool is_fused, size_t tile_size = 1)
+            {
+                is_fused_ = is_fused;
+                tile_size_ = std::max<size_t>(1, tile_size);
+            }
+            void setTiming(bool is_timing) { is_timing_ = is_timing; }
+            void setSeed(uint64_t seed)
+            {
+                seed_ = seed;
+                if (random_)
+                {
+                    *random_ = Tools::Random(seed);
+                }
+            }
+            void setFitnessCache(std::shared_ptr<FitnessCache_> fitness_cache) { fitnessCache_ = fitness_cache; }
+            // Polled between chromosomes, a cancelled run drops the unfinished generation and returns the population.
+            void setCancellationToken(std::shared_ptr<Tools::CancellationToken> token) { cancellationToken_ = token; }
+            // Published at the start and after every generation, for observers on other threads.
+            void setPopulationSnapshots(std::shared_ptr<PopulationSnapshots_> snapshots) { populationSnapshots_ = snapshots; }
+
+            bool isParallel() const { return is_parallel_; }
+            bool isRecycling() const { return is_recycling_; }
+            bool isFused() const { return is_fused_; }
+            bool isTiming() const { return is_timing_; }
+            // Accumulated over all timed generations until cleared.
+            EvolutionStats& getEvolutionStats() { return evolutionStats_; }
+            const EvolutionStats& getEvolutionStats() const { return evolutionStats_; }
+            std::shared_ptr<FitnessCache_> getFitnessCache() const { return fitnessCache_; }
+            std::shared_ptr<Tools::WorkerPool> getWorkerPool() const { return workerPool_; }
+            std::shared_ptr<Tools::CancellationToken> getCancellationToken() const { return cancellationToken_; }
+            std::shared_ptr<PopulationSnapshots_> getPopulationSnapshots() const { return populationSnapshots_; }
+            // Generator seeded by setSeed, meant to be shared with the operators (not thread-safe).
+            std::shared_ptr<Tools::Random> getRandom()
+            {
+                if (!random_)
+                {
+                    random_ = std::make_shared<Tools::Random>(seed_);
+                }
+                return random_;
+            }
 
             Population_ evolution(Population_& population) override
             {
-                __set_interface_error(fitnessFunction_, "Fitness Function");
+                if (!batchFitnessFunction_)
+                {
+                    __set_interface_error(fitnessFunction_, "Fitness Function");
+                }
                 __set_interface_error(conditionsForStopping_, "Conditions For Stopping");
+                if (is_fused_ && mutation_)
+                {
+                    std::__throw_logic_error("fused mode does not support a generation Mutation, use a Chromosome Mutation");
+                }
 
                 if (startEvolutionLog_)
                 {
@@ -63,12 +156,44 @@ namespace HeuristicAlgorithm
                 }
 
                 calc_fitness_(population.get()[0]);
+                if (populationSnapshots_)
+                {
+                    populationSnapshots_->reset(population);
+                }
 
-                while (!(*conditionsForStopping_)(population))
+                while (!is_cancelled_() && !(*conditionsForStopping_)(population))
                 {
+                    StageTimer timer(is_timing_ ? &evolutionStats_ : nullptr);
                     Generation_ new_generation;
+                    if (is_recycling_)
+                    {
+                        new_generation = std::move(spare_);
+                    }
+                    Tools::Random& random = *getRandom();
+                    Tools::Random generation_random = random.split(random());
 
-                    if (crossingover_)
+                    if (chromosomeCrossingover_)
+                    {
+                        new_generation.get().resize(num_offspring_ ? num_offspring_ : population.get()[0].get().size());
+                        if (!is_fused_)
+                        {
+                            for_each_chromosome_(new_generation, generation_random.split(0), [this, &population](Chromosome_& chromosome, size_t ind, Tools::Random& random)
+                            {
+                                (*chromosomeCrossingover_)(population, chromosome, ind, random);
+                            });
+                        }
+                    }
+                    else if (recyclingCrossingover_)
+                    {
+                        (*recyclingCrossingover_)(population, new_generation);
+                    }
+                    else if (crossingover_ && is_recycling_)
+                    {
+                        // copy-assigned so the spare keeps its buffers, only the result of the operator itself is allocated
+                        const Generation_ offspring = (*crossingover_)(population);
+                        new_generation = offspring;
+                    }
+                    else if (crossingover_)
                     {
                         new_generation = (*crossingover_)(population);
                     }
@@ -76,29 +201,82 @@ namespace HeuristicAlgorithm
                     {
                         new_generation = population.get()[0];
                     }
+                    timer.stop(Stage::crossingover);
 
-                    if (mutation_)
+                    if (is_fused_)
+                    {
+                        fused_pass_(population, new_generation, generation_random);
+                        timer.stop(Stage::fused);
+                    }
+                    else
                     {
-                        (*mutation_)(new_generation);
+                        if (mutation_)
+                        {
+                            (*mutation_)(new_generation);
+                        }
+                        if (chromosomeMutation_)
+                        {
+                            for_each_chromosome_(new_generation, generation_random.split(1), [this](Chromosome_& chromosome, size_t ind, Tools::Random& random)
+                            {
+                                (*chromosomeMutation_)(chromosome, ind, random);
+                            });
+                        }
+                        timer.stop(Stage::mutation);
+
+                        calc_fitness_(new_generation);
+                        timer.stop(Stage::fitness);
                     }
 
-                    calc_fitness_(new_generation);
+                    if (is_cancelled_())
+                    {
+                        if (is_recycling_)
+                        {
+                            spare_ = std::move(new_generation);
+                        }
+                        break;
+                    }
 
                     if (selection_)
                     {
                         (*selection_)(new_generation);
                     }
+                    timer.stop(Stage::selection);
                     if (newGenerationLog_)
                     {
                         (*newGenerationLog_)(new_generation);
                     }
+                    timer.stop(Stage::log);
 
-                    population.get().push(std::move(new_generation));
+                    if (is_recycling_)
+                    {
+                        std::swap(population.get().push_slot(), new_generation);
+                        spare_ = std::move(new_generation);
+                    }
+                    else
+                    {
+                        population.get().push(std::move(new_generation));
+                    }
+                    timer.skip();
 
                     if (anyFunction_)
                     {
                         (*anyFunction_)(population);
                     }
+                    timer.stop(Stage::any_function);
+                    if (migration_)
+                    {
+                        (*migration_)(population);
+                    }
+                    timer.stop(Stage::migration);
+                    if (populationSnapshots_)
+                    {
+                        populationSnapshots_->publish(population);
+                    }
+                    timer.finish();
+                    if (evolutionStatsLog_)
+                    {
+                        (*evolutionStatsLog_)(evolutionStats_);
+                    }
                 }
 
                 if (endEvolutionLog_)
@@ -119,54 +297,236 @@ namespace HeuristicAlgorithm
                 }
             }
 
-            void calc_fitness_(Generation_& generation)
+            // Every chromosome gets its own stream split from random by its index,
+            // so the result does not depend on the number of threads or the chunk size.
+            template <class Function>
+            void for_each_chromosome_(Generation_& generation, const Tools::Random& random, Function&& fun)
             {
-                if (is_parallel_)
+                for_each_range_(generation.get().size(), [this, &generation, &random, &fun](size_t begin, size_t end)
                 {
-                    std::vector<std::thread> threads;
-                    auto& fitnessFunction = fitnessFunction_;
-                    std::function calc_fitness = [&fitnessFunction](Chromosome_ &chromosome)
+                    for (size_t i = begin; i < end && !is_cancelled_(); ++i)
                     {
-                        chromosome.getFitness() = (*fitnessFunction)(chromosome);
-                    };
+                        Tools::Random chromosome_random = random.split(i);
+                        fun(generation.get()[i], i, chromosome_random);
+                    }
+                });
+            }
 
-                    for (Chromosome_ &chromosome : generation.get())
+            template <class Function>
+            void for_each_range_(size_t num_items, Function&& fun)
+            {
+                if (is_parallel_)
+                {
+                    get_worker_pool_()->parallel_for(num_items, fun, chunk_size_);
+                }
+                else
+                {
+                    fun(0, num_items);
+                }
+            }
+
+            // Same random streams as the separate passes, so both modes give the same generation.
+            // A tile keeps its pending chromosomes in pending_ from its first index on, so ranges share the buffers without locks.
+            void fused_pass_(const Population_& population, Generation_& generation, const Tools::Random& random)
+            {
+                Tools::Random crossingover_random = random.split(0);
+                Tools::Random mutation_random = random.split(1);
+                pending_.resize(generation.get().size());
+                pending_hashes_.resize(generation.get().size());
+                for_each_range_(generation.get().size(), [&](size_t begin, size_t end)
+                {
+                    for (size_t tile = begin; tile < end && !is_cancelled_(); tile += tile_size_)
                     {
-                        if (!chromosome.getFitness().has_value())
+                        Chromosome_** pending = pending_.data() + tile;
+                        size_t* hashes = pending_hashes_.data() + tile;
+                        size_t num_pending = 0;
+                        for (size_t i = tile; i < std::min(end, tile + tile_size_); ++i)
+                        {
+                            Chromosome_& chromosome = generation.get()[i];
+                            if (chromosomeCrossingover_)
+                            {
+                                Tools::Random chromosome_random = crossingover_random.split(i);
+                                (*chromosomeCrossingover_)(population, chromosome, i, chromosome_random);
+                            }
+                            if (chromosomeMutation_)
+                            {
+                                Tools::Random chromosome_random = mutation_random.split(i);
+                                (*chromosomeMutation_)(chromosome, i, chromosome_random);
+                            }
+                            size_t hash = 0;
+                            if (!resolve_fitness_(chromosome, hash))
+                            {
+                                pending[num_pending] = &chromosome;
+                                hashes[num_pending++] = hash;
+                            }
+                        }
+                        if (is_cancelled_() || num_pending == 0)
+                        {
+                            continue;
+                        }
+                        if (batchFitnessFunction_)
+                        {
+                            (*batchFitnessFunction_)(Tools::Span<Chromosome_*>(pending, num_pending));
+                        }
+                        else
                         {
-                            threads.push_back(std::thread(calc_fitness, std::ref(chromosome)));
+                            for (size_t i = 0; i < num_pending; ++i)
+                            {
+                                pending[i]->getFitness() = (*fitnessFunction_)(*pending[i]);
+                            }
+                        }
+                        if (fitnessCache_)
+                        {
+                            for (size_t i = 0; i < num_pending; ++i)
+                            {
+                                fitnessCache_->insert(*pending[i], hashes[i]);
+                            }
                         }
                     }
+                });
+            }
 
-                    for (auto &thread: threads)
+            // Fills the fitness without the fitness function if possible, otherwise returns false and the cache hash.
+            bool resolve_fitness_(Chromosome_& chromosome, size_t& hash)
+            {
+                if (chromosome.getFitness().has_value())
+                {
+                    return true;
+                }
+                // O(changed genes), cheaper than hashing for the cache or handing the chromosome to the pool
+                if (incrementalFitnessFunction_ && chromosome.getParentFitness().has_value())
+                {
+                    chromosome.getFitness() = (*incrementalFitnessFunction_)(chromosome, *chromosome.getParentFitness(), chromosome.getChanges());
+                    chromosome.clearChanges();
+                    return true;
+                }
+                chromosome.clearChanges();
+                if (fitnessCache_)
+                {
+                    hash = fitnessCache_->hash(chromosome);
+                    if (auto fitness = fitnessCache_->find(chromosome, hash))
                     {
-                        thread.join();
+                        chromosome.getFitness() = std::move(fitness);
+                        return true;
                     }
                 }
+                return false;
+            }
+
+            const std::shared_ptr<Tools::WorkerPool>& get_worker_pool_()
+            {
+                if (!workerPool_)
+                {
+                    workerPool_ = std::make_shared<Tools::WorkerPool>(num_threads_ ? num_threads_ : std::thread::hardware_concurrency());
+                }
+                return workerPool_;
+            }
+
+            void calc_fitness_(Generation_& generation)
+            {
+                pending_.clear();
+                pending_hashes_.clear();
+                if (is_cancelled_())
+                {
+                    return;
+                }
+                for (Chromosome_ &chromosome : generation.get())
+                {
+                    size_t hash = 0;
+                    if (resolve_fitness_(chromosome, hash))
+                    {
+                        continue;
+                    }
+                    if (fitnessCache_)
+                    {
+                        pending_hashes_.push_back(hash);
+                    }
+                    pending_.push_back(&chromosome);
+                }
+                if (pending_.empty())
+                {
+                    return;
+                }
+
+                if (is_parallel_)
+                {
+                    get_worker_pool_()->parallel_for(pending_.size(), [this](size_t begin, size_t end)
+                    {
+                        calc_fitness_range_(begin, end);
+                    }, chunk_size_);
+                }
                 else
                 {
-                    for (Chromosome_ &chromosome : generation.get())
+                    calc_fitness_range_(0, pending_.size());
+                }
+
+                if (fitnessCache_)
+                {
+                    for (size_t i = 0; i < pending_.size(); ++i)
                     {
-                        if (!chromosome.getFitness().has_value())
+                        if (!pending_[i]->getFitness().has_value())
                         {
-                            chromosome.getFitness() = (*fitnessFunction_)(chromosome);
+                            continue;
                         }
+                        fitnessCache_->insert(*pending_[i], pending_hashes_[i]);
                     }
                 }
             }
 
+            bool is_cancelled_() const { return cancellationToken_ && cancellationToken_->isCancelled(); }
+
+            void calc_fitness_range_(size_t begin, size_t end)
+            {
+                if (batchFitnessFunction_)
+                {
+                    if (!is_cancelled_())
+                    {
+                        (*batchFitnessFunction_)(Tools::Span<Chromosome_*>(pending_.data() + begin, end - begin));
+                    }
+                    return;
+                }
+                for (size_t i = begin; i < end && !is_cancelled_(); ++i)
+                {
+                    pending_[i]->getFitness() = (*fitnessFunction_)(*pending_[i]);
+                }
+            }
+
             std::shared_ptr<FitnessFunction_> fitnessFunction_;
+            std::shared_ptr<BatchFitnessFunction_> batchFitnessFunction_;
+            std::shared_ptr<IncrementalFitnessFunction_> incrementalFitnessFunction_;
             std::shared_ptr<Selection_> selection_;
             std::shared_ptr<Mutation_> mutation_;
             std::shared_ptr<Crossingover_> crossingover_;
+            std::shared_ptr<RecyclingCrossingover_> recyclingCrossingover_;
+            std::shared_ptr<ChromosomeMutation_> chromosomeMutation_;
+            std::shared_ptr<ChromosomeCrossingover_> chromosomeCrossingover_;
             std::shared_ptr<ConditionsForStopping_> conditionsForStopping_;
             std::shared_ptr<AnyFunction_> anyFunction_;
+            std::shared_ptr<Migration_> migration_;
 
             std::shared_ptr<StartEvolutionLog_> startEvolutionLog_;
             std::shared_ptr<EndEvolutionLog_> endEvolutionLog_;
             std::shared_ptr<NewGenerationLog_> newGenerationLog_;
+            std::shared_ptr<EvolutionStatsLog_> evolutionStatsLog_;
             
-            bool is_parallel_;
+            bool is_parallel_ = false;
+            bool is_recycling_ = false;
+            bool is_timing_ = false;
+            bool is_fused_ = false;
+            size_t tile_size_ = 1;
+            EvolutionStats evolutionStats_;
+            Generation_ spare_;
+            size_t num_offspring_ = 0;
+            uint64_t seed_ = 0;
+            size_t num_threads_ = 0;
+            size_t chunk_size_ = 0;
+            std::shared_ptr<Tools::WorkerPool> workerPool_;
+            std::shared_ptr<FitnessCache_> fitnessCache_;
+            std::shared_ptr<Tools::Random> random_;
+            std::shared_ptr<Tools::CancellationToken> cancellationToken_;
+            std::shared_ptr<PopulationSnapshots_> populationSnapshots_;
+            std::vector<Chromosome_*> pending_;
+            std::vector<size_t> pending_hashes_;
         };
     }
 }
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "types.hpp"
+#include "dense_generation.hpp"
+#include "evolution_stats.hpp"
 #include "../algorithm.hpp"
+#include "../tools/span.hpp"
+#include "../tools/random.hpp"
 
 #include <array>
 #include <vector>
@@ -20,6 +24,18 @@ namespace HeuristicAlgorithm
             {
             };
 
+            template <class GeneType, class FitnessType>
+            struct BatchFitnessFunctionWrapper : public Wrapper<void, Tools::Span<Chromosome<GeneType, FitnessType> *>>
+            {
+            };
+
+            // Fitness of a chromosome from its parent fitness and the (index, old value) changes made since, in order.
+            template <class GeneType, class FitnessType>
+            struct IncrementalFitnessFunctionWrapper : public Wrapper<FitnessType, const Chromosome<GeneType, FitnessType> &, const FitnessType &,
+                                                                      const std::vector<std::pair<size_t, GeneType>> &>
+            {
+            };
+
             template <class GeneType, class FitnessType>
             struct SelectionWrapper : public Wrapper<void, Generation<GeneType, FitnessType> &>
             {
@@ -30,6 +46,59 @@ namespace HeuristicAlgorithm
             {
             };
 
+            // Selection over the dense fitness array of the generation: only fitness values and their flags are gathered
+            // (genes are not copied), select() scans them and fills the indices of the kept chromosomes (repeats allowed),
+            // the kept chromosomes are then copy-assigned into a reused generation. Buffers are reused between calls.
+            template <class GeneType, class FitnessType>
+            struct DenseSelectionWrapper : public SelectionWrapper<GeneType, FitnessType>
+            {
+                using Generation_ = Generation<GeneType, FitnessType>;
+                using DenseFitness_ = DenseFitness<FitnessType>;
+
+                virtual void select(const DenseFitness_ &fitness, std::vector<size_t> &selected) = 0;
+
+                void operator()(Generation_ &generation) override
+                {
+                    fitness_.assign(generation);
+                    selected_.clear();
+                    select(fitness_, selected_);
+                    result_.get().resize(selected_.size());
+                    for (size_t i = 0; i < selected_.size(); ++i)
+                    {
+                        if (selected_[i] >= generation.get().size())
+                        {
+                            std::__throw_out_of_range("DenseSelectionWrapper");
+                        }
+                        result_.get()[i] = generation.get()[selected_[i]];
+                    }
+                    std::swap(generation, result_);
+                }
+
+            protected:
+                DenseFitness_ fitness_;
+                std::vector<size_t> selected_;
+                Generation_ result_;
+            };
+
+            // Stop condition over the dense fitness array of the newest generation and the number of generations so far.
+            template <class GeneType, class FitnessType>
+            struct DenseConditionsForStoppingWrapper : public ConditionsForStoppingWrapper<GeneType, FitnessType>
+            {
+                using Population_ = Population<GeneType, FitnessType>;
+                using DenseFitness_ = DenseFitness<FitnessType>;
+
+                virtual bool stop(const DenseFitness_ &fitness, size_t num_generations) = 0;
+
+                bool operator()(const Population_ &population) override
+                {
+                    fitness_.assign(population.get()[0]);
+                    return stop(fitness_, population.get().size());
+                }
+
+            protected:
+                DenseFitness_ fitness_;
+            };
+
             template <class GeneType, class FitnessType>
             struct MutationWrapper : public Wrapper<void, Generation<GeneType, FitnessType> &>
             {
@@ -40,11 +109,49 @@ namespace HeuristicAlgorithm
             {
             };
 
+            template <class GeneType, class FitnessType>
+            struct RecyclingCrossingoverWrapper : public Wrapper<void, const Population<GeneType, FitnessType> &, Generation<GeneType, FitnessType> &>
+            {
+            };
+
+            // Mutation of a single chromosome with the given index, may run concurrently for different chromosomes.
+            template <class GeneType, class FitnessType>
+            struct ChromosomeMutationWrapper : public Wrapper<void, Chromosome<GeneType, FitnessType> &, size_t, Tools::Random &>
+            {
+            };
+
+            // Builds the offspring with the given index into the passed chromosome (which holds the previous contents of the slot),
+            // may run concurrently for different offspring.
+            template <class GeneType, class FitnessType>
+            struct ChromosomeCrossingoverWrapper : public Wrapper<void, const Population<GeneType, FitnessType> &, Chromosome<GeneType, FitnessType> &, size_t, Tools::Random &>
+            {
+            };
+
             template <class GeneType, class FitnessType>
             struct AnyFunctionWrapper : public Wrapper<void, Population<GeneType, FitnessType> &>
             {
             };
 
+            template <class GeneType, class FitnessType>
+            struct MigrationWrapper : public Wrapper<void, Population<GeneType, FitnessType> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType>
+            struct EmigrationWrapper : public Wrapper<Generation<GeneType, FitnessType>, const Population<GeneType, FitnessType> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType>
+            struct ImmigrationWrapper : public Wrapper<void, Population<GeneType, FitnessType> &, Generation<GeneType, FitnessType> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType>
+            struct PoolingPopulationsWrapper : public Wrapper<Population<GeneType, FitnessType>, std::vector<Population<GeneType, FitnessType>> &>
+            {
+            };
+
             template <class GeneType, class FitnessType>
             struct StartEvolutionLogWrapper : public Wrapper<void, const Population<GeneType, FitnessType> &>
             {
@@ -60,72 +167,56 @@ namespace HeuristicAlgorithm
             {
             };
 
-            // template <class GeneType, class FitnessType, size_t num_genes>
-            // struct StatFitnessFunctionWrapper : public Wrapper<FitnessType, const StatChromosome<GeneType, FitnessType, num_genes> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
-            // struct StatSelectionWrapper : public Wrapper<void, StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatConditionsForStoppingWrapper : public Wrapper<bool, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
-            // struct StatMutationWrapper : public Wrapper<void, StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatCrossingoverWrapper : public Wrapper<StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes>,
-            //                                                 const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatAnyFunctionWrapper : public Wrapper<void, StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatStartPopulationWrapper : public Wrapper<StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size, size_t num_populations>
-            // struct StatPoolingPopulationsWrapper : public Wrapper<StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>,
-            //                                                     std::array<StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>, num_populations> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatStartEvolutionLogWrapper : public Wrapper<void, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &, const std::string &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatEndEvolutionLogWrapper : public Wrapper<void, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &, const std::string &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
-            // struct StatNewGenerationLogWrapper : public Wrapper<void, const StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &, const std::string &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatStartNodeFunctionWrapper : public Wrapper<void, StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
-            // {
-            // };
-
-            // template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
-            // struct StatEndNodeFunctionWrapper : public Wrapper<void, StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
-            // {
-            // };
+            template <class GeneType, class FitnessType>
+            struct EvolutionStatsLogWrapper : public Wrapper<void, const EvolutionStats &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes>
+            struct StatFitnessFunctionWrapper : public Wrapper<FitnessType, const StatChromosome<GeneType, FitnessType, num_genes> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
+            struct StatSelectionWrapper : public Wrapper<void, StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+            struct StatConditionsForStoppingWrapper : public Wrapper<bool, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
+            struct StatMutationWrapper : public Wrapper<void, StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+            struct StatCrossingoverWrapper : public Wrapper<void, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &,
+                                                            StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+            struct StatAnyFunctionWrapper : public Wrapper<void, StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+            struct StatStartEvolutionLogWrapper : public Wrapper<void, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+            struct StatEndEvolutionLogWrapper : public Wrapper<void, const StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size> &>
+            {
+            };
+
+            template <class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes>
+            struct StatNewGenerationLogWrapper : public Wrapper<void, const StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes> &>
+            {
+            };
         } // end namespace Interfaces
     } // end namespace GeneticAlgorithm
 } // end namespace HeuristicAlgorithm
\ No newline at end of file
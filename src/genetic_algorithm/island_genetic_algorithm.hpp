@@ -0,0 +1,285 @@
+#pragma once
+
+#include "genetic_algorithm.hpp"
+#include "../tools/worker_pool.hpp"
+#include "../tools/random.hpp"
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        enum class MigrationTopology
+        {
+            ring,
+            fully_connected,
+            random
+        };
+
+        // Copies the num_migrants best chromosomes of the last generation.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct BestEmigration: public EmigrationWrapper<GeneType, FitnessType>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Generation_ = Generation<GeneType, FitnessType>;
+
+            BestEmigration(size_t num_migrants, Compare compare = Compare()): num_migrants_(num_migrants), compare_(compare) {}
+
+            Generation_ operator()(const Population<GeneType, FitnessType>& population) override
+            {
+                const auto& chromosomes = population.get()[0].get();
+                std::vector<const Chromosome_*> order(chromosomes.size());
+                for (size_t i = 0; i < chromosomes.size(); ++i)
+                {
+                    order[i] = &chromosomes[i];
+                }
+                size_t num_migrants = std::min(num_migrants_, order.size());
+                std::partial_sort(order.begin(), order.begin() + num_migrants, order.end(), [this](const Chromosome_* a, const Chromosome_* b)
+                {
+                    return a->getFitness().has_value() && (!b->getFitness().has_value() || compare_(*a->getFitness(), *b->getFitness()));
+                });
+                Generation_ migrants;
+                migrants.get().reserve(num_migrants);
+                for (size_t i = 0; i < num_migrants; ++i)
+                {
+                    migrants.get().push_back(*order[i]);
+                }
+                return migrants;
+            }
+
+            size_t num_migrants_;
+            Compare compare_;
+        };
+
+        // Replaces the worst chromosomes of the last generation with the migrants.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct ReplaceWorstImmigration: public ImmigrationWrapper<GeneType, FitnessType>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Generation_ = Generation<GeneType, FitnessType>;
+
+            ReplaceWorstImmigration(Compare compare = Compare()): compare_(compare) {}
+
+            void operator()(Population<GeneType, FitnessType>& population, Generation_& migrants) override
+            {
+                auto& chromosomes = population.get()[0].get();
+                size_t num_migrants = std::min(migrants.get().size(), chromosomes.size());
+                auto better = [this](const Chromosome_& a, const Chromosome_& b)
+                {
+                    return a.getFitness().has_value() && (!b.getFitness().has_value() || compare_(*a.getFitness(), *b.getFitness()));
+                };
+                std::nth_element(chromosomes.begin(), chromosomes.end() - num_migrants, chromosomes.end(), better);
+                for (size_t i = 0; i < num_migrants; ++i)
+                {
+                    chromosomes[chromosomes.size() - num_migrants + i] = std::move(migrants.get()[i]);
+                }
+            }
+
+            Compare compare_;
+        };
+
+        // Runs several GeneticAlgorithm islands concurrently, every island starts from a copy of the input population.
+        // Every migration_interval generations an island sends its emigrants to its neighbours and takes in whatever
+        // arrived in its own mailbox, so islands never wait for each other.
+        // Islands must not share stateful operators, emigration / immigration functors are shared by all islands.
+        template<class GeneType, class FitnessType>
+        struct IslandGeneticAlgorithm: public Algorithm<Population<GeneType, FitnessType>, Population<GeneType, FitnessType>>
+        {
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+            using GeneticAlgorithm_ = GeneticAlgorithm<GeneType, FitnessType>;
+
+            using Emigration_ = EmigrationWrapper<GeneType, FitnessType>;
+            using Immigration_ = ImmigrationWrapper<GeneType, FitnessType>;
+            using PoolingPopulations_ = PoolingPopulationsWrapper<GeneType, FitnessType>;
+
+            void addIsland(std::shared_ptr<GeneticAlgorithm_> island) { islands_.push_back(island); }
+
+            void setEmigration(std::shared_ptr<Emigration_> fun) { emigration_ = fun; }
+            void setImmigration(std::shared_ptr<Immigration_> fun) { immigration_ = fun; }
+            void setPoolingPopulations(std::shared_ptr<PoolingPopulations_> fun) { poolingPopulations_ = fun; }
+
+            void setMigrationInterval(size_t migration_interval) { migration_interval_ = migration_interval; }
+            void setMigrationTopology(MigrationTopology migration_topology) { migration_topology_ = migration_topology; }
+            // Seed of the whole run: the generator of every island and its migration are split from it.
+            void setSeed(uint64_t seed) { seed_ = seed; }
+            // Runs the islands, one per chunk. The same pool may also be given to the islands (GeneticAlgorithm::setWorkerPool):
+            // their parallel_for calls then run inline on the island's thread instead of blocking on the pool.
+            void setWorkerPool(std::shared_ptr<Tools::WorkerPool> worker_pool) { workerPool_ = worker_pool; }
+
+            size_t numIslands() const { return islands_.size(); }
+
+            Population_ evolution(Population_& population) override
+            {
+                if (islands_.empty())
+                {
+                    std::__throw_logic_error("no islands");
+                }
+                __set_interface_error(emigration_, "Emigration");
+                __set_interface_error(immigration_, "Immigration");
+                if (migration_interval_ == 0)
+                {
+                    std::__throw_logic_error("migration interval must be greater than 0");
+                }
+                if (!workerPool_)
+                {
+                    workerPool_ = std::make_shared<Tools::WorkerPool>(islands_.size());
+                }
+
+                size_t num_islands = islands_.size();
+                mailboxes_.clear();
+                for (size_t i = 0; i < num_islands; ++i)
+                {
+                    mailboxes_.push_back(std::make_unique<Mailbox>());
+                }
+
+                // every island starts from the same population, so each needs its own generator to diverge
+                std::vector<Population_> populations(num_islands, population);
+                for (size_t i = 0; i < num_islands; ++i)
+                {
+                    islands_[i]->setSeed(island_random_(i).split(0)());
+                    islands_[i]->setMigration(std::make_shared<IslandMigration>(*this, i));
+                }
+
+                try
+                {
+                    workerPool_->parallel_for(num_islands, [this, &populations](size_t begin, size_t end)
+                    {
+                        for (size_t i = begin; i < end; ++i)
+                        {
+                            populations[i] = islands_[i]->evolution(populations[i]);
+                        }
+                    }, 1);
+                }
+                catch (...)
+                {
+                    reset_islands_();
+                    throw;
+                }
+                reset_islands_();
+
+                if (poolingPopulations_)
+                {
+                    return (*poolingPopulations_)(populations);
+                }
+                Generation_ generation;
+                for (auto& island_population: populations)
+                {
+                    for (auto& chromosome: island_population.get()[0].get())
+                    {
+                        generation.get().push_back(std::move(chromosome));
+                    }
+                }
+                Population_ res(population.get().capacity());
+                res.get().push(std::move(generation));
+                return res;
+            }
+
+        protected:
+            Tools::Random island_random_(size_t island) const { return Tools::Random(seed_).split(island); }
+
+            struct Mailbox
+            {
+                std::mutex mtx_;
+                std::vector<Generation_> migrants_;
+            };
+
+            struct IslandMigration: public MigrationWrapper<GeneType, FitnessType>
+            {
+                IslandMigration(IslandGeneticAlgorithm& islands, size_t island): islands_(islands), island_(island), random_(islands.island_random_(island).split(1)) {}
+
+                void operator()(Population_& population) override
+                {
+                    if (++generation_ % islands_.migration_interval_ != 0)
+                    {
+                        return;
+                    }
+                    size_t num_islands = islands_.islands_.size();
+                    if (num_islands > 1)
+                    {
+                        Generation_ emigrants = (*islands_.emigration_)(population);
+                        switch (islands_.migration_topology_)
+                        {
+                        case MigrationTopology::ring:
+                        {
+                            send_((island_ + 1) % num_islands, std::move(emigrants));
+                            break;
+                        }
+                        case MigrationTopology::fully_connected:
+                        {
+                            for (size_t i = 1; i < num_islands; ++i)
+                            {
+                                send_((island_ + i) % num_islands, emigrants);
+                            }
+                            break;
+                        }
+                        case MigrationTopology::random:
+                        {
+                            send_((island_ + 1 + random_.uniformInt(num_islands - 1)) % num_islands, std::move(emigrants));
+                            break;
+                        }
+                        }
+                    }
+
+                    Mailbox& mailbox = *islands_.mailboxes_[island_];
+                    {
+                        std::lock_guard<std::mutex> lock(mailbox.mtx_);
+                        std::swap(incoming_, mailbox.migrants_);
+                    }
+                    for (auto& immigrants: incoming_)
+                    {
+                        (*islands_.immigration_)(population, immigrants);
+                    }
+                    incoming_.clear();
+                }
+
+                void send_(size_t island, Generation_ emigrants)
+                {
+                    Mailbox& mailbox = *islands_.mailboxes_[island];
+                    std::lock_guard<std::mutex> lock(mailbox.mtx_);
+                    mailbox.migrants_.push_back(std::move(emigrants));
+                }
+
+                IslandGeneticAlgorithm& islands_;
+                size_t island_;
+                size_t generation_ = 0;
+                Tools::Random random_;
+                std::vector<Generation_> incoming_;
+            };
+
+            template <class Interface>
+            void __set_interface_error(const std::shared_ptr<Interface> &interface, std::string interface_name) const
+            {
+                if (!interface)
+                {
+                    std::__throw_logic_error(("not set interface \"" + interface_name + "\"").c_str());
+                }
+            }
+
+            void reset_islands_()
+            {
+                for (auto& island: islands_)
+                {
+                    island->setMigration(nullptr);
+                }
+            }
+
+            std::vector<std::shared_ptr<GeneticAlgorithm_>> islands_;
+            std::shared_ptr<Emigration_> emigration_;
+            std::shared_ptr<Immigration_> immigration_;
+            std::shared_ptr<PoolingPopulations_> poolingPopulations_;
+
+            size_t migration_interval_ = 10;
+            MigrationTopology migration_topology_ = MigrationTopology::ring;
+            uint64_t seed_ = 0;
+            std::shared_ptr<Tools::WorkerPool> workerPool_;
+            std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+        };
+    }
+}
@@ -0,0 +1,466 @@
+#pragma once
+
+#include "interfaces.hpp"
+#include "types.hpp"
+#include "bit_genes.hpp"
+#include "../tools/random.hpp"
+#include "../tools/alias_table.hpp"
+
+#include <memory>
+#include <vector>
+#include <optional>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+        using namespace Interfaces;
+
+        template <class FitnessType>
+        struct FitnessWeight
+        {
+            double operator()(const FitnessType &fitness) const { return static_cast<double>(fitness); }
+        };
+
+        // Moves the num_elite best (by Compare) chromosomes to the front in O(n), the rest stays unordered.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        void partitionElite(Generation<GeneType, FitnessType>& generation, size_t num_elite, Compare compare = Compare())
+        {
+            auto& chromosomes = generation.get();
+            if (num_elite == 0 || num_elite >= chromosomes.size())
+            {
+                return;
+            }
+            std::nth_element(chromosomes.begin(), chromosomes.begin() + (num_elite - 1), chromosomes.end(),
+                             [&compare](const Chromosome<GeneType, FitnessType>& a, const Chromosome<GeneType, FitnessType>& b)
+            {
+                return compare(*a.getFitness(), *b.getFitness());
+            });
+        }
+
+        // Keeps generation_size chromosomes, each is the best (by Compare) of tournament_size uniformly drawn ones.
+        // The num_elite best chromosomes are kept unconditionally.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct TournamentSelection: public SelectionWrapper<GeneType, FitnessType>
+        {
+            using Generation_ = Generation<GeneType, FitnessType>;
+
+            TournamentSelection(size_t generation_size, size_t tournament_size, std::shared_ptr<Tools::Random> random, Compare compare = Compare()):
+                generation_size_(generation_size), tournament_size_(tournament_size), random_(random), compare_(compare) {}
+
+            void setNumElite(size_t num_elite) { num_elite_ = num_elite; }
+
+            void operator()(Generation_& generation) override
+            {
+                auto& chromosomes = generation.get();
+                if (chromosomes.empty())
+                {
+                    return;
+                }
+                selected_.get().resize(generation_size_);
+                size_t num_elite = std::min({num_elite_, generation_size_, chromosomes.size()});
+                partitionElite(generation, num_elite, compare_);
+                for (size_t i = 0; i < num_elite; ++i)
+                {
+                    selected_.get()[i] = chromosomes[i];
+                }
+                for (size_t i = num_elite; i < generation_size_; ++i)
+                {
+                    size_t winner = random_->uniformInt(chromosomes.size());
+                    for (size_t j = 1; j < tournament_size_; ++j)
+                    {
+                        size_t contestant = random_->uniformInt(chromosomes.size());
+                        if (compare_(*chromosomes[contestant].getFitness(), *chromosomes[winner].getFitness()))
+                        {
+                            winner = contestant;
+                        }
+                    }
+                    selected_.get()[i] = chromosomes[winner];
+                }
+                std::swap(generation, selected_);
+            }
+
+            size_t generation_size_;
+            size_t tournament_size_;
+            size_t num_elite_ = 0;
+            std::shared_ptr<Tools::Random> random_;
+            Compare compare_;
+            Generation_ selected_;
+        };
+
+        // Keeps generation_size chromosomes drawn with probability proportional to Weight(fitness) (non-negative),
+        // the alias table makes each draw O(1) without sorting the generation.
+        // The num_elite best (by Compare) chromosomes are kept unconditionally.
+        template<class GeneType, class FitnessType, class Weight = FitnessWeight<FitnessType>, class Compare = std::greater<FitnessType>>
+        struct RouletteSelection: public SelectionWrapper<GeneType, FitnessType>
+        {
+            using Generation_ = Generation<GeneType, FitnessType>;
+
+            RouletteSelection(size_t generation_size, std::shared_ptr<Tools::Random> random, Weight weight = Weight(), Compare compare = Compare()):
+                generation_size_(generation_size), random_(random), weight_(weight), compare_(compare) {}
+
+            void setNumElite(size_t num_elite) { num_elite_ = num_elite; }
+
+            void operator()(Generation_& generation) override
+            {
+                auto& chromosomes = generation.get();
+                if (chromosomes.empty())
+                {
+                    return;
+                }
+                selected_.get().resize(generation_size_);
+                size_t num_elite = std::min({num_elite_, generation_size_, chromosomes.size()});
+                // the weights are taken after the partition, so the drawn indices match the reordered chromosomes
+                partitionElite(generation, num_elite, compare_);
+                weights_.resize(chromosomes.size());
+                for (size_t i = 0; i < chromosomes.size(); ++i)
+                {
+                    weights_[i] = weight_(*chromosomes[i].getFitness());
+                }
+                aliasTable_.assign(weights_.begin(), weights_.end());
+                for (size_t i = 0; i < num_elite; ++i)
+                {
+                    selected_.get()[i] = chromosomes[i];
+                }
+                for (size_t i = num_elite; i < generation_size_; ++i)
+                {
+                    selected_.get()[i] = chromosomes[aliasTable_(*random_)];
+                }
+                std::swap(generation, selected_);
+            }
+
+            size_t generation_size_;
+            size_t num_elite_ = 0;
+            std::shared_ptr<Tools::Random> random_;
+            Weight weight_;
+            Compare compare_;
+            std::vector<double> weights_;
+            Tools::AliasTable aliasTable_;
+            Generation_ selected_;
+        };
+
+        // TournamentSelection over the dense fitness array: tournaments read only contiguous fitness values.
+        // Chromosomes without fitness never win against evaluated ones.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct DenseTournamentSelection: public DenseSelectionWrapper<GeneType, FitnessType>
+        {
+            using DenseFitness_ = DenseFitness<FitnessType>;
+
+            DenseTournamentSelection(size_t generation_size, size_t tournament_size, std::shared_ptr<Tools::Random> random, Compare compare = Compare()):
+                generation_size_(generation_size), tournament_size_(tournament_size), random_(random), compare_(compare) {}
+
+            void select(const DenseFitness_& generation, std::vector<size_t>& selected) override
+            {
+                if (generation.size() == 0)
+                {
+                    return;
+                }
+                const auto& fitness = generation.fitness();
+                const auto& has_fitness = generation.fitnessFlags();
+                selected.resize(generation_size_);
+                for (size_t i = 0; i < generation_size_; ++i)
+                {
+                    size_t winner = random_->uniformInt(generation.size());
+                    for (size_t j = 1; j < tournament_size_; ++j)
+                    {
+                        size_t contestant = random_->uniformInt(generation.size());
+                        if (has_fitness[contestant] && (!has_fitness[winner] || compare_(fitness[contestant], fitness[winner])))
+                        {
+                            winner = contestant;
+                        }
+                    }
+                    selected[i] = winner;
+                }
+            }
+
+            size_t generation_size_;
+            size_t tournament_size_;
+            std::shared_ptr<Tools::Random> random_;
+            Compare compare_;
+        };
+
+        // Stops after max_generations generations or once the best fitness of the newest generation reaches target
+        // (compare(best, target) or equal), a single pass over the dense fitness array.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct DenseTargetFitnessStop: public DenseConditionsForStoppingWrapper<GeneType, FitnessType>
+        {
+            using DenseFitness_ = DenseFitness<FitnessType>;
+
+            DenseTargetFitnessStop(FitnessType target, size_t max_generations, Compare compare = Compare()):
+                target_(target), max_generations_(max_generations), compare_(compare) {}
+
+            bool stop(const DenseFitness_& generation, size_t num_generations) override
+            {
+                if (num_generations >= max_generations_)
+                {
+                    return true;
+                }
+                std::optional<size_t> best = generation.best(compare_);
+                return best && !compare_(target_, generation.fitness()[*best]);
+            }
+
+            FitnessType target_;
+            size_t max_generations_;
+            Compare compare_;
+        };
+
+        // Offspring of two uniformly drawn chromosomes of the last generation (of equal size) with num_points cut points.
+        // Bit genes are copied word by word.
+        template<class GeneType, class FitnessType>
+        struct KPointCrossingover: public ChromosomeCrossingoverWrapper<GeneType, FitnessType>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+            using Genes_ = typename Chromosome_::Genes_;
+
+            KPointCrossingover(size_t num_points = 1): num_points_(num_points) {}
+
+            void operator()(const Population_& population, Chromosome_& chromosome, size_t, Tools::Random& random) override
+            {
+                const auto& parents = population.get()[0].get();
+                const Genes_& first = parents[random.uniformInt(parents.size())].cget();
+                const Genes_& second = parents[random.uniformInt(parents.size())].cget();
+                Genes_& genes = chromosome.get();
+                genes = first;
+                size_t size = genes.size();
+                if (size < 2)
+                {
+                    return;
+                }
+
+                thread_local std::vector<size_t> points;
+                points.resize(num_points_);
+                for (size_t& point: points)
+                {
+                    point = 1 + random.uniformInt(size - 1);
+                }
+                std::sort(points.begin(), points.end());
+                for (size_t i = 0; i < points.size(); i += 2)
+                {
+                    assign_range_(genes, second, points[i], i + 1 < points.size() ? points[i + 1] : size);
+                }
+            }
+
+        protected:
+            static void assign_range_(BitGenes& genes, const BitGenes& other, size_t begin, size_t end)
+            {
+                genes.assignRange(other, begin, end);
+            }
+            template <class Genes>
+            static void assign_range_(Genes& genes, const Genes& other, size_t begin, size_t end)
+            {
+                std::copy(other.begin() + begin, other.begin() + end, genes.begin() + begin);
+            }
+
+            size_t num_points_;
+        };
+
+        // Offspring taking every gene from one of two uniformly drawn chromosomes with probability 1/2,
+        // one random word decides 64 genes.
+        template<class GeneType, class FitnessType>
+        struct UniformCrossingover: public ChromosomeCrossingoverWrapper<GeneType, FitnessType>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+            using Genes_ = typename Chromosome_::Genes_;
+
+            void operator()(const Population_& population, Chromosome_& chromosome, size_t, Tools::Random& random) override
+            {
+                const auto& parents = population.get()[0].get();
+                const Genes_& first = parents[random.uniformInt(parents.size())].cget();
+                const Genes_& second = parents[random.uniformInt(parents.size())].cget();
+                Genes_& genes = chromosome.get();
+                genes = first;
+                assign_masked_(genes, second, random);
+            }
+
+        protected:
+            static void assign_masked_(BitGenes& genes, const BitGenes& other, Tools::Random& random)
+            {
+                thread_local std::vector<uint64_t> mask;
+                mask.resize(genes.numWords());
+                for (uint64_t& word: mask)
+                {
+                    word = random();
+                }
+                genes.assignMasked(other, mask.data());
+            }
+            template <class Genes>
+            static void assign_masked_(Genes& genes, const Genes& other, Tools::Random& random)
+            {
+                uint64_t bits = 0;
+                for (size_t i = 0; i < genes.size(); ++i, bits >>= 1)
+                {
+                    if (i % 64 == 0)
+                    {
+                        bits = random();
+                    }
+                    if (bits & 1)
+                    {
+                        genes[i] = other[i];
+                    }
+                }
+            }
+        };
+
+        // Flips every gene with the given probability, the cost is proportional to the number of flips.
+        // Chromosomes with index < first_chromosome (e.g. elite copies) are kept.
+        template<class FitnessType>
+        struct BitFlipMutation: public ChromosomeMutationWrapper<bool, FitnessType>
+        {
+            BitFlipMutation(double probability, size_t first_chromosome = 0): probability_(probability), first_chromosome_(first_chromosome) {}
+
+            void operator()(Chromosome<bool, FitnessType>& chromosome, size_t ind, Tools::Random& random) override
+            {
+                if (ind < first_chromosome_)
+                {
+                    return;
+                }
+                random.forEachSuccess(chromosome.cget().size(), probability_, [&chromosome](size_t i)
+                {
+                    chromosome.changeGene(i, !chromosome.cget()[i]);
+                });
+            }
+
+            double probability_;
+            size_t first_chromosome_;
+        };
+
+        // Adds N(0, sigma) to every gene with the given probability, the result is clamped to [lower, upper].
+        // Chromosomes with index < first_chromosome (e.g. elite copies) are kept.
+        template<class FitnessType>
+        struct GaussianMutation: public ChromosomeMutationWrapper<double, FitnessType>
+        {
+            GaussianMutation(double probability, double sigma,
+                             double lower = -std::numeric_limits<double>::infinity(), double upper = std::numeric_limits<double>::infinity(),
+                             size_t first_chromosome = 0):
+                probability_(probability), sigma_(sigma), lower_(lower), upper_(upper), first_chromosome_(first_chromosome) {}
+
+            void operator()(Chromosome<double, FitnessType>& chromosome, size_t ind, Tools::Random& random) override
+            {
+                if (ind < first_chromosome_)
+                {
+                    return;
+                }
+                std::normal_distribution<double> normal(0., sigma_);
+                random.forEachSuccess(chromosome.cget().size(), probability_, [&chromosome, &normal, &random, this](size_t i)
+                {
+                    chromosome.changeGene(i, std::clamp(chromosome.cget()[i] + normal(random), lower_, upper_));
+                });
+            }
+
+            double probability_;
+            double sigma_;
+            double lower_;
+            double upper_;
+            size_t first_chromosome_;
+        };
+
+        // Deb's polynomial mutation with distribution index eta, every gene is mutated with the given probability within [lower, upper].
+        // Chromosomes with index < first_chromosome (e.g. elite copies) are kept.
+        template<class FitnessType>
+        struct PolynomialMutation: public ChromosomeMutationWrapper<double, FitnessType>
+        {
+            PolynomialMutation(double probability, double eta, double lower, double upper, size_t first_chromosome = 0):
+                probability_(probability), eta_(eta), lower_(lower), upper_(upper), first_chromosome_(first_chromosome)
+            {
+                if (!(lower < upper) || !std::isfinite(lower) || !std::isfinite(upper))
+                {
+                    std::__throw_logic_error("polynomial mutation needs finite bounds lower < upper");
+                }
+            }
+
+            void operator()(Chromosome<double, FitnessType>& chromosome, size_t ind, Tools::Random& random) override
+            {
+                if (ind < first_chromosome_)
+                {
+                    return;
+                }
+                random.forEachSuccess(chromosome.cget().size(), probability_, [&chromosome, &random, this](size_t i)
+                {
+                    chromosome.changeGene(i, mutate_(chromosome.cget()[i], random.uniformReal()));
+                });
+            }
+
+        protected:
+            double mutate_(double x, double u) const
+            {
+                double range = upper_ - lower_;
+                double power = 1. / (eta_ + 1.);
+                double delta;
+                if (u < 0.5)
+                {
+                    double xy = 1. - (x - lower_) / range;
+                    double value = 2. * u + (1. - 2. * u) * std::pow(xy, eta_ + 1.);
+                    delta = std::pow(value, power) - 1.;
+                }
+                else
+                {
+                    double xy = 1. - (upper_ - x) / range;
+                    double value = 2. * (1. - u) + 2. * (u - 0.5) * std::pow(xy, eta_ + 1.);
+                    delta = 1. - std::pow(value, power);
+                }
+                return std::clamp(x + delta * range, lower_, upper_);
+            }
+
+            double probability_;
+            double eta_;
+            double lower_;
+            double upper_;
+            size_t first_chromosome_;
+        };
+
+        // Adapters running a per-chromosome operator serially over a generation with a shared generator,
+        // for setCrossingover / setMutation.
+        template<class GeneType, class FitnessType>
+        struct GenerationCrossingover: public CrossingoverWrapper<GeneType, FitnessType>
+        {
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using ChromosomeCrossingover_ = ChromosomeCrossingoverWrapper<GeneType, FitnessType>;
+
+            GenerationCrossingover(std::shared_ptr<ChromosomeCrossingover_> crossingover, size_t num_offspring, std::shared_ptr<Tools::Random> random):
+                crossingover_(crossingover), num_offspring_(num_offspring), random_(random) {}
+
+            Generation_ operator()(const Population<GeneType, FitnessType>& population) override
+            {
+                Generation_ res(num_offspring_);
+                for (size_t i = 0; i < num_offspring_; ++i)
+                {
+                    (*crossingover_)(population, res.get()[i], i, *random_);
+                }
+                return res;
+            }
+
+            std::shared_ptr<ChromosomeCrossingover_> crossingover_;
+            size_t num_offspring_;
+            std::shared_ptr<Tools::Random> random_;
+        };
+
+        template<class GeneType, class FitnessType>
+        struct GenerationMutation: public MutationWrapper<GeneType, FitnessType>
+        {
+            using ChromosomeMutation_ = ChromosomeMutationWrapper<GeneType, FitnessType>;
+
+            GenerationMutation(std::shared_ptr<ChromosomeMutation_> mutation, std::shared_ptr<Tools::Random> random):
+                mutation_(mutation), random_(random) {}
+
+            void operator()(Generation<GeneType, FitnessType>& generation) override
+            {
+                for (size_t i = 0; i < generation.get().size(); ++i)
+                {
+                    (*mutation_)(generation.get()[i], i, *random_);
+                }
+            }
+
+            std::shared_ptr<ChromosomeMutation_> mutation_;
+            std::shared_ptr<Tools::Random> random_;
+        };
+    }
+}
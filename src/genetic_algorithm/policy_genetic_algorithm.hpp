@@ -0,0 +1,144 @@
+#pragma once
+
+#include "types.hpp"
+#include "../algorithm.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+
+        // Placeholder for an optional stage of PolicyGeneticAlgorithm, the stage is compiled out.
+        struct NoOperator {};
+
+        // Same stage order as GeneticAlgorithm::evolution, but every operator is a template parameter held by value,
+        // so the calls are resolved (and can be inlined) at compile time. Operators derived from the *Wrapper
+        // interfaces work as well; declare them final to let the compiler devirtualize the call.
+        template<class GeneType, class FitnessType,
+                 class FitnessFunction, class ConditionsForStopping,
+                 class Selection = NoOperator, class Mutation = NoOperator, class Crossingover = NoOperator, class AnyFunction = NoOperator,
+                 class StartEvolutionLog = NoOperator, class EndEvolutionLog = NoOperator, class NewGenerationLog = NoOperator>
+        struct PolicyGeneticAlgorithm: public Algorithm<Population<GeneType, FitnessType>, Population<GeneType, FitnessType>>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+
+            PolicyGeneticAlgorithm(FitnessFunction fitness_function = FitnessFunction(),
+                                   ConditionsForStopping conditions_for_stopping = ConditionsForStopping(),
+                                   Selection selection = Selection(),
+                                   Mutation mutation = Mutation(),
+                                   Crossingover crossingover = Crossingover(),
+                                   AnyFunction any_function = AnyFunction(),
+                                   StartEvolutionLog start_evolution_log = StartEvolutionLog(),
+                                   EndEvolutionLog end_evolution_log = EndEvolutionLog(),
+                                   NewGenerationLog new_generation_log = NewGenerationLog()):
+                fitnessFunction_(std::move(fitness_function)),
+                conditionsForStopping_(std::move(conditions_for_stopping)),
+                selection_(std::move(selection)),
+                mutation_(std::move(mutation)),
+                crossingover_(std::move(crossingover)),
+                anyFunction_(std::move(any_function)),
+                startEvolutionLog_(std::move(start_evolution_log)),
+                endEvolutionLog_(std::move(end_evolution_log)),
+                newGenerationLog_(std::move(new_generation_log)) {}
+
+            FitnessFunction& getFitnessFunction() { return fitnessFunction_; }
+            ConditionsForStopping& getConditionsForStopping() { return conditionsForStopping_; }
+            Selection& getSelection() { return selection_; }
+            Mutation& getMutation() { return mutation_; }
+            Crossingover& getCrossingover() { return crossingover_; }
+            AnyFunction& getAnyFunction() { return anyFunction_; }
+
+            Population_ evolution(Population_& population) override
+            {
+                if constexpr (has_<StartEvolutionLog>)
+                {
+                    startEvolutionLog_(std::as_const(population));
+                }
+
+                if (population.get().size() == 0)
+                {
+                    std::__throw_logic_error("empty population");
+                }
+
+                calc_fitness_(population.get()[0]);
+
+                while (!conditionsForStopping_(std::as_const(population)))
+                {
+                    Generation_ new_generation;
+
+                    if constexpr (has_<Crossingover>)
+                    {
+                        new_generation = crossingover_(std::as_const(population));
+                    }
+                    else
+                    {
+                        new_generation = population.get()[0];
+                    }
+
+                    if constexpr (has_<Mutation>)
+                    {
+                        mutation_(new_generation);
+                    }
+
+                    calc_fitness_(new_generation);
+
+                    if constexpr (has_<Selection>)
+                    {
+                        selection_(new_generation);
+                    }
+                    if constexpr (has_<NewGenerationLog>)
+                    {
+                        newGenerationLog_(std::as_const(new_generation));
+                    }
+
+                    population.get().push(std::move(new_generation));
+
+                    if constexpr (has_<AnyFunction>)
+                    {
+                        anyFunction_(population);
+                    }
+                }
+
+                if constexpr (has_<EndEvolutionLog>)
+                {
+                    endEvolutionLog_(std::as_const(population));
+                }
+
+                return std::move(population);
+            }
+
+        protected:
+            template <class Operator>
+            static constexpr bool has_ = !std::is_same<Operator, NoOperator>::value;
+
+            void calc_fitness_(Generation_& generation)
+            {
+                for (Chromosome_ &chromosome : generation.get())
+                {
+                    if (!chromosome.getFitness().has_value())
+                    {
+                        chromosome.getFitness() = fitnessFunction_(std::as_const(chromosome));
+                    }
+                }
+            }
+
+            FitnessFunction fitnessFunction_;
+            ConditionsForStopping conditionsForStopping_;
+            Selection selection_;
+            Mutation mutation_;
+            Crossingover crossingover_;
+            AnyFunction anyFunction_;
+
+            StartEvolutionLog startEvolutionLog_;
+            EndEvolutionLog endEvolutionLog_;
+            NewGenerationLog newGenerationLog_;
+        };
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+
+        // Read-only copies of the last depth generations of a running population for observer threads.
+        // One writer (the algorithm) publishes, any number of readers take snapshots without blocking it:
+        // a snapshot is an immutable list of shared generation copies swapped in atomically,
+        // so a reader keeps a consistent view for as long as it holds it.
+        // A publish copies only the new generation and shares the older ones with the previous snapshot,
+        // buffers no reader holds any more are reused, so after warm-up publishing does not allocate.
+        template <class GeneType, class FitnessType>
+        class PopulationSnapshots
+        {
+        public:
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+
+            struct Entry
+            {
+                // number of the generation in the population, population.get().size() after its push
+                size_t number = 0;
+                Generation_ generation;
+            };
+
+            // [0] is the newest generation.
+            class Snapshot
+            {
+            public:
+                const Generation_& operator[](size_t ind) const { return entries_.at(ind)->generation; }
+                size_t number(size_t ind) const { return entries_.at(ind)->number; }
+                size_t size() const { return entries_.size(); }
+                bool empty() const { return entries_.empty(); }
+
+            protected:
+                friend class PopulationSnapshots;
+                std::vector<std::shared_ptr<const Entry>> entries_;
+            };
+
+            PopulationSnapshots(size_t depth = 1): depth_(depth), current_(std::make_shared<Snapshot>())
+            {
+                if (depth_ == 0) {std::__throw_logic_error("snapshot depth must be greater than 0");}
+            }
+
+            size_t depth() const { return depth_; }
+
+            // Reader side, safe from any thread.
+            std::shared_ptr<const Snapshot> snapshot() const { return std::atomic_load(&current_); }
+
+            // Writer side: republishes the newest depth generations of the population.
+            void reset(const Population_& population)
+            {
+                std::shared_ptr<Snapshot> snapshot = free_snapshot_();
+                const auto& generations = population.get();
+                size_t num_generations = std::min(depth_, generations.count());
+                for (size_t i = 0; i < num_generations; ++i)
+                {
+                    snapshot->entries_.push_back(copy_(generations.size() - i, generations[i]));
+                }
+                std::atomic_store(&current_, std::shared_ptr<const Snapshot>(snapshot));
+            }
+
+            // Writer side: publishes population.get()[0] as the newest generation.
+            void publish(const Population_& population)
+            {
+                std::shared_ptr<const Snapshot> previous = current_;
+                std::shared_ptr<Snapshot> snapshot = free_snapshot_();
+                snapshot->entries_.push_back(copy_(population.get().size(), population.get()[0]));
+                for (size_t i = 0; i < previous->entries_.size() && snapshot->entries_.size() < depth_; ++i)
+                {
+                    snapshot->entries_.push_back(previous->entries_[i]);
+                }
+                previous.reset();
+                std::atomic_store(&current_, std::shared_ptr<const Snapshot>(snapshot));
+            }
+
+        protected:
+            // An object only the pool owns cannot be reached by readers: they get references from published snapshots only.
+            // The fence pairs with the release decrement of the last reader before the buffer is overwritten.
+            template <class Type>
+            static std::shared_ptr<Type> take_free_(std::vector<std::shared_ptr<Type>>& pool)
+            {
+                for (std::shared_ptr<Type>& item: pool)
+                {
+                    if (item.use_count() == 1)
+                    {
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        return item;
+                    }
+                }
+                pool.push_back(std::make_shared<Type>());
+                return pool.back();
+            }
+
+            std::shared_ptr<Snapshot> free_snapshot_()
+            {
+                std::shared_ptr<Snapshot> snapshot = take_free_(snapshots_);
+                snapshot->entries_.clear();
+                snapshot->entries_.reserve(depth_);
+                return snapshot;
+            }
+
+            std::shared_ptr<const Entry> copy_(size_t number, const Generation_& generation)
+            {
+                std::shared_ptr<Entry> entry = take_free_(entries_);
+                entry->number = number;
+                entry->generation = generation;
+                return entry;
+            }
+
+            size_t depth_;
+            // written only by the writer, published with atomic_store
+            std::shared_ptr<const Snapshot> current_;
+            std::vector<std::shared_ptr<Snapshot>> snapshots_;
+            std::vector<std::shared_ptr<Entry>> entries_;
+        };
+    }
+}
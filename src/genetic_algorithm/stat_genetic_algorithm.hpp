@@ -0,0 +1,149 @@
+#pragma once
+
+#include "interfaces.hpp"
+#include "types.hpp"
+#include "../algorithm.hpp"
+
+#include <memory>
+#include <string>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+        using namespace Interfaces;
+
+        // GeneticAlgorithm over compile-time sized types, the evolution loop does not allocate.
+        // Stages still dispatch through virtual calls of the shared_ptr<Stat*Wrapper> operators, so loops are not unrolled
+        // across the operator boundary; PolicyGeneticAlgorithm takes the operators as template parameters for that.
+        template<class GeneType, class FitnessType, size_t num_genes, size_t num_chromosomes, size_t suffix_size>
+        struct StatGeneticAlgorithm: public Algorithm<StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>,
+                                                      StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>>
+        {
+            using StatChromosome_ = StatChromosome<GeneType, FitnessType, num_genes>;
+            using StatGeneration_ = StatGeneration<GeneType, FitnessType, num_genes, num_chromosomes>;
+            using StatPopulation_ = StatPopulation<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+
+            using StatFitnessFunction_ = StatFitnessFunctionWrapper<GeneType, FitnessType, num_genes>;
+            using StatSelection_ = StatSelectionWrapper<GeneType, FitnessType, num_genes, num_chromosomes>;
+            using StatMutation_ = StatMutationWrapper<GeneType, FitnessType, num_genes, num_chromosomes>;
+            using StatCrossingover_ = StatCrossingoverWrapper<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+            using StatConditionsForStopping_ = StatConditionsForStoppingWrapper<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+            using StatAnyFunction_ = StatAnyFunctionWrapper<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+
+            using StatStartEvolutionLog_ = StatStartEvolutionLogWrapper<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+            using StatEndEvolutionLog_ = StatEndEvolutionLogWrapper<GeneType, FitnessType, num_genes, num_chromosomes, suffix_size>;
+            using StatNewGenerationLog_ = StatNewGenerationLogWrapper<GeneType, FitnessType, num_genes, num_chromosomes>;
+
+            void setFitnessFunction(std::shared_ptr<StatFitnessFunction_> fun) { fitnessFunction_ = fun; }
+            void setSelection(std::shared_ptr<StatSelection_> fun) { selection_ = fun; }
+            void setMutation(std::shared_ptr<StatMutation_> fun) { mutation_ = fun; }
+            void setCrossingover(std::shared_ptr<StatCrossingover_> fun) { crossingover_ = fun; }
+            void setConditionsForStopping(std::shared_ptr<StatConditionsForStopping_> fun) { conditionsForStopping_ = fun; }
+            void setAnyFunction(std::shared_ptr<StatAnyFunction_> fun) { anyFunction_ = fun; }
+
+            void setStartEvolutionLog(std::shared_ptr<StatStartEvolutionLog_> fun) { startEvolutionLog_ = fun; }
+            void setEndEvolutionLog(std::shared_ptr<StatEndEvolutionLog_> fun) { endEvolutionLog_ = fun; }
+            void setNewGenerationLog(std::shared_ptr<StatNewGenerationLog_> fun) { newGenerationLog_ = fun; }
+
+            StatPopulation_ evolution(StatPopulation_& population) override
+            {
+                __set_interface_error(fitnessFunction_, "Fitness Function");
+                __set_interface_error(conditionsForStopping_, "Conditions For Stopping");
+
+                if (startEvolutionLog_)
+                {
+                    (*startEvolutionLog_)(population);
+                }
+
+                if (population.get().size() == 0)
+                {
+                    std::__throw_logic_error("empty population");
+                }
+
+                calc_fitness_(population.get()[0]);
+
+                while (!(*conditionsForStopping_)(population))
+                {
+                    // new_generation_ is a member so that large fixed-size generations never land on the stack
+                    if (crossingover_)
+                    {
+                        (*crossingover_)(population, new_generation_);
+                    }
+                    else
+                    {
+                        new_generation_ = population.get()[0];
+                    }
+
+                    if (mutation_)
+                    {
+                        (*mutation_)(new_generation_);
+                    }
+
+                    calc_fitness_(new_generation_);
+
+                    if (selection_)
+                    {
+                        (*selection_)(new_generation_);
+                    }
+                    if (newGenerationLog_)
+                    {
+                        (*newGenerationLog_)(new_generation_);
+                    }
+
+                    population.get().push_slot() = new_generation_;
+
+                    if (anyFunction_)
+                    {
+                        (*anyFunction_)(population);
+                    }
+                }
+
+                if (endEvolutionLog_)
+                {
+                    (*endEvolutionLog_)(population);
+                }
+
+                return std::move(population);
+            }
+
+        protected:
+            template <class Interface>
+            void __set_interface_error(const std::shared_ptr<Interface> &interface, std::string interface_name) const
+            {
+                if (!interface)
+                {
+                    std::__throw_logic_error(("not set interface \"" + interface_name + "\"").c_str());
+                }
+            }
+
+            void calc_fitness_(StatGeneration_& generation)
+            {
+                for (StatChromosome_ &chromosome : generation.get())
+                {
+                    if (!chromosome.getFitness().has_value())
+                    {
+                        chromosome.getFitness() = (*fitnessFunction_)(chromosome);
+                    }
+                }
+            }
+
+            std::shared_ptr<StatFitnessFunction_> fitnessFunction_;
+            std::shared_ptr<StatSelection_> selection_;
+            std::shared_ptr<StatMutation_> mutation_;
+            std::shared_ptr<StatCrossingover_> crossingover_;
+            std::shared_ptr<StatConditionsForStopping_> conditionsForStopping_;
+            std::shared_ptr<StatAnyFunction_> anyFunction_;
+
+            std::shared_ptr<StatStartEvolutionLog_> startEvolutionLog_;
+            std::shared_ptr<StatEndEvolutionLog_> endEvolutionLog_;
+            std::shared_ptr<StatNewGenerationLog_> newGenerationLog_;
+
+            StatGeneration_ new_generation_;
+        };
+    }
+}
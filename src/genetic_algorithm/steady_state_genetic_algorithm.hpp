@@ -0,0 +1,350 @@
+#pragma once
+
+#include "interfaces.hpp"
+#include "types.hpp"
+#include "../algorithm.hpp"
+#include "../tools/worker_pool.hpp"
+#include "../tools/cancellation.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+namespace HeuristicAlgorithm
+{
+    namespace GeneticAlgorithm
+    {
+        using namespace Types;
+        using namespace Interfaces;
+
+        enum class ReplacementPolicy
+        {
+            selection,
+            replace_worst
+        };
+
+        // Variant of GeneticAlgorithm without generation barriers. Workers take single offspring from a shared queue, evaluate them
+        // without holding any lock and insert the result into the last generation of the population as soon as it is ready.
+        // When the queue runs dry one worker copies the newest generation under the lock, runs Crossingover + Mutation on the copy
+        // without the lock and locks again only to append the offspring; meanwhile evaluations and inserts go on, and only
+        // workers that find the queue empty wait for the refill. Offspring that already have fitness (unchanged copies of parents) are skipped.
+        //  - ReplacementPolicy::replace_worst: an offspring replaces the worst chromosome if it is better (by Compare).
+        //  - ReplacementPolicy::selection: offspring are collected until report_interval of them arrived, then
+        //    Selection is applied to the last generation extended by them, as in GeneticAlgorithm.
+        // Every report_interval inserted offspring NewGenerationLog, AnyFunction and ConditionsForStopping are called.
+        template<class GeneType, class FitnessType, class Compare = std::greater<FitnessType>>
+        struct SteadyStateGeneticAlgorithm: public Algorithm<Population<GeneType, FitnessType>, Population<GeneType, FitnessType>>
+        {
+            using Chromosome_ = Chromosome<GeneType, FitnessType>;
+            using Generation_ = Generation<GeneType, FitnessType>;
+            using Population_ = Population<GeneType, FitnessType>;
+
+            using FitnessFunction_ = FitnessFunctionWrapper<GeneType, FitnessType>;
+            using Selection_ = SelectionWrapper<GeneType, FitnessType>;
+            using Mutation_ = MutationWrapper<GeneType, FitnessType>;
+            using Crossingover_ = CrossingoverWrapper<GeneType, FitnessType>;
+            using ConditionsForStopping_ = ConditionsForStoppingWrapper<GeneType, FitnessType>;
+            using AnyFunction_ = AnyFunctionWrapper<GeneType, FitnessType>;
+
+            using StartEvolutionLog_ = StartEvolutionLogWrapper<GeneType, FitnessType>;
+            using EndEvolutionLog_ = EndEvolutionLogWrapper<GeneType, FitnessType>;
+            using NewGenerationLog_ = NewGenerationLogWrapper<GeneType, FitnessType>;
+
+            SteadyStateGeneticAlgorithm(Compare compare = Compare()): compare_(compare) {}
+
+            void setFitnessFunction(std::shared_ptr<FitnessFunction_> fun) { fitnessFunction_ = fun; }
+            void setSelection(std::shared_ptr<Selection_> fun) { selection_ = fun; }
+            void setMutation(std::shared_ptr<Mutation_> fun) { mutation_ = fun; }
+            void setCrossingover(std::shared_ptr<Crossingover_> fun) { crossingover_ = fun; }
+            void setConditionsForStopping(std::shared_ptr<ConditionsForStopping_> fun) { conditionsForStopping_ = fun; }
+            void setAnyFunction(std::shared_ptr<AnyFunction_> fun) { anyFunction_ = fun; }
+
+            void setStartEvolutionLog(std::shared_ptr<StartEvolutionLog_> fun) { startEvolutionLog_ = fun; }
+            void setEndEvolutionLog(std::shared_ptr<EndEvolutionLog_> fun) { endEvolutionLog_ = fun; }
+            void setNewGenerationLog(std::shared_ptr<NewGenerationLog_> fun) { newGenerationLog_ = fun; }
+
+            void setReplacementPolicy(ReplacementPolicy replacement_policy) { replacement_policy_ = replacement_policy; }
+            void setReportInterval(size_t report_interval) { report_interval_ = report_interval; }
+            void setNumThreads(size_t num_threads) { num_threads_ = num_threads; workerPool_.reset(); }
+            void setWorkerPool(std::shared_ptr<Tools::WorkerPool> worker_pool) { workerPool_ = worker_pool; }
+            // Polled after every evaluation, offspring evaluated after the cancellation are dropped.
+            void setCancellationToken(std::shared_ptr<Tools::CancellationToken> token) { cancellationToken_ = token; }
+
+            size_t numInserted() const { return num_inserted_; }
+
+            Population_ evolution(Population_& population) override
+            {
+                __set_interface_error(fitnessFunction_, "Fitness Function");
+                __set_interface_error(conditionsForStopping_, "Conditions For Stopping");
+                __set_interface_error(crossingover_, "Crossingover");
+                if (replacement_policy_ == ReplacementPolicy::selection)
+                {
+                    __set_interface_error(selection_, "Selection");
+                }
+
+                if (startEvolutionLog_)
+                {
+                    (*startEvolutionLog_)(population);
+                }
+
+                if (population.get().size() == 0)
+                {
+                    std::__throw_logic_error("empty population");
+                }
+
+                for (Chromosome_ &chromosome : population.get()[0].get())
+                {
+                    if (!chromosome.getFitness().has_value() && !is_cancelled_())
+                    {
+                        chromosome.getFitness() = (*fitnessFunction_)(chromosome);
+                    }
+                }
+
+                if (!workerPool_)
+                {
+                    workerPool_ = std::make_shared<Tools::WorkerPool>(num_threads_ ? num_threads_ : std::thread::hardware_concurrency());
+                }
+
+                population_ = &population;
+                queue_.clear();
+                arrivals_.get().clear();
+                num_inserted_ = 0;
+                version_ = parents_version_ + 1;
+                is_stopped_ = is_cancelled_() || (*conditionsForStopping_)(population);
+
+                workerPool_->parallel_for(workerPool_->size(), [this](size_t begin, size_t end)
+                {
+                    run_();
+                }, 1);
+
+                population_ = nullptr;
+                queue_.clear();
+                arrivals_.get().clear();
+
+                if (endEvolutionLog_)
+                {
+                    (*endEvolutionLog_)(population);
+                }
+
+                return std::move(population);
+            }
+
+        protected:
+            template <class Interface>
+            void __set_interface_error(const std::shared_ptr<Interface> &interface, std::string interface_name) const
+            {
+                if (!interface)
+                {
+                    std::__throw_logic_error(("not set interface \"" + interface_name + "\"").c_str());
+                }
+            }
+
+            void run_()
+            {
+                try
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    while (!is_stopped_)
+                    {
+                        if (is_cancelled_())
+                        {
+                            is_stopped_ = true;
+                            break;
+                        }
+                        if (queue_.empty())
+                        {
+                            if (is_refilling_)
+                            {
+                                refilled_cv_.wait(lock, [this]()->bool { return !is_refilling_ || is_stopped_; });
+                            }
+                            else
+                            {
+                                refill_(lock);
+                            }
+                            continue;
+                        }
+                        Chromosome_ offspring = std::move(queue_.front());
+                        queue_.pop_front();
+                        lock.unlock();
+
+                        offspring.getFitness() = (*fitnessFunction_)(offspring);
+
+                        lock.lock();
+                        if (!is_stopped_ && !is_cancelled_())
+                        {
+                            insert_(std::move(offspring));
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mtx_);
+                        is_stopped_ = true;
+                    }
+                    refilled_cv_.notify_all();
+                    throw;
+                }
+            }
+
+            // Called with lock held, releases it for Crossingover and Mutation, which run on a one-generation copy of the population:
+            // the newest generation is copy-assigned into the single slot of parents_ (only one refill at a time, so its buffers
+            // are reused), and not copied at all when the population has not changed since the last refill.
+            void refill_(std::unique_lock<std::mutex>& lock)
+            {
+                is_refilling_ = true;
+                if (parents_version_ != version_)
+                {
+                    parents_.get().push(population_->get()[0]);
+                    parents_version_ = version_;
+                }
+                lock.unlock();
+
+                Generation_ offspring;
+                try
+                {
+                    offspring = (*crossingover_)(parents_);
+                    if (mutation_)
+                    {
+                        (*mutation_)(offspring);
+                    }
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    is_refilling_ = false;
+                    throw;
+                }
+
+                lock.lock();
+                is_refilling_ = false;
+                refilled_cv_.notify_all();
+                if (is_stopped_)
+                {
+                    return;
+                }
+                for (Chromosome_ &chromosome : offspring.get())
+                {
+                    if (!chromosome.getFitness().has_value())
+                    {
+                        queue_.push_back(std::move(chromosome));
+                    }
+                }
+                if (queue_.empty())
+                {
+                    report_();
+                }
+            }
+
+            // called under mtx_
+            void insert_(Chromosome_ offspring)
+            {
+                ++version_;
+                auto& chromosomes = population_->get()[0].get();
+                if (replacement_policy_ == ReplacementPolicy::replace_worst)
+                {
+                    size_t worst = 0;
+                    for (size_t i = 1; i < chromosomes.size(); ++i)
+                    {
+                        if (compare_(*chromosomes[worst].getFitness(), *chromosomes[i].getFitness()))
+                        {
+                            worst = i;
+                        }
+                    }
+                    if (chromosomes.empty())
+                    {
+                        chromosomes.push_back(std::move(offspring));
+                    }
+                    else if (compare_(*offspring.getFitness(), *chromosomes[worst].getFitness()))
+                    {
+                        chromosomes[worst] = std::move(offspring);
+                    }
+                }
+                else
+                {
+                    arrivals_.get().push_back(std::move(offspring));
+                }
+
+                if (++num_inserted_ % interval_() == 0)
+                {
+                    if (replacement_policy_ == ReplacementPolicy::selection)
+                    {
+                        for (Chromosome_ &chromosome : arrivals_.get())
+                        {
+                            chromosomes.push_back(std::move(chromosome));
+                        }
+                        arrivals_.get().clear();
+                        (*selection_)(population_->get()[0]);
+                    }
+                    report_();
+                }
+            }
+
+            // called under mtx_
+            void report_()
+            {
+                ++version_;
+                if (newGenerationLog_)
+                {
+                    (*newGenerationLog_)(population_->get()[0]);
+                }
+                if (anyFunction_)
+                {
+                    (*anyFunction_)(*population_);
+                }
+                is_stopped_ = (*conditionsForStopping_)(*population_);
+            }
+
+            bool is_cancelled_() const { return cancellationToken_ && cancellationToken_->isCancelled(); }
+
+            size_t interval_() const
+            {
+                if (report_interval_)
+                {
+                    return report_interval_;
+                }
+                return std::max<size_t>(1, population_->get()[0].get().size());
+            }
+
+            std::shared_ptr<FitnessFunction_> fitnessFunction_;
+            std::shared_ptr<Selection_> selection_;
+            std::shared_ptr<Mutation_> mutation_;
+            std::shared_ptr<Crossingover_> crossingover_;
+            std::shared_ptr<ConditionsForStopping_> conditionsForStopping_;
+            std::shared_ptr<AnyFunction_> anyFunction_;
+
+            std::shared_ptr<StartEvolutionLog_> startEvolutionLog_;
+            std::shared_ptr<EndEvolutionLog_> endEvolutionLog_;
+            std::shared_ptr<NewGenerationLog_> newGenerationLog_;
+
+            Compare compare_;
+            ReplacementPolicy replacement_policy_ = ReplacementPolicy::replace_worst;
+            size_t report_interval_ = 0;
+            size_t num_threads_ = 0;
+            std::shared_ptr<Tools::WorkerPool> workerPool_;
+            std::shared_ptr<Tools::CancellationToken> cancellationToken_;
+
+            std::mutex mtx_;
+            std::condition_variable refilled_cv_;
+            bool is_refilling_ = false;
+            // newest generation the last refill copied, and the population version it was copied at
+            Population_ parents_;
+            size_t parents_version_ = 0;
+            // changed by every insert and report under mtx_
+            size_t version_ = 0;
+            Population_* population_ = nullptr;
+            std::deque<Chromosome_> queue_;
+            Generation_ arrivals_;
+            size_t num_inserted_ = 0;
+            bool is_stopped_ = false;
+        };
+    }
+}
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
 #include <optional>
 #include <utility>
 
+#include "bit_genes.hpp"
 #include "../tools/suffix.hpp"
 
 namespace HeuristicAlgorithm
@@ -14,12 +16,25 @@ namespace HeuristicAlgorithm
     {
         namespace Types
         {
+            template <class GeneType>
+            struct GenesContainer
+            {
+                using type = std::vector<GeneType>;
+            };
+
+            template <>
+            struct GenesContainer<bool>
+            {
+                using type = BitGenes;
+            };
+
             template <class GeneType, class FitnessType>
             class Chromosome
             {
             public:
-                using Genes_ = std::vector<GeneType>;
+                using Genes_ = typename GenesContainer<GeneType>::type;
                 using Chromosome_ = Chromosome<GeneType, FitnessType>;
+                using Changes_ = std::vector<std::pair<size_t, GeneType>>;
 
                 Chromosome() : genes_() {}
                 Chromosome(const typename Genes_::allocator_type &__a) : genes_(__a) {}
@@ -37,15 +52,19 @@ namespace HeuristicAlgorithm
                 {
                     genes_ = genes;
                     fitness_.reset();
+                    clearChanges();
                     return *this;
                 }
-                Chromosome(const Chromosome_ &chromosome) : genes_(chromosome.genes_), fitness_(chromosome.fitness_) {}
+                Chromosome(const Chromosome_ &chromosome) :
+                    genes_(chromosome.genes_), fitness_(chromosome.fitness_), parent_fitness_(chromosome.parent_fitness_), changes_(chromosome.changes_) {}
                 Chromosome_ &operator=(const Chromosome_ &chromosome)
                 {
                     if (this != &chromosome)
                     {
                         genes_ = chromosome.genes_;
                         fitness_ = chromosome.fitness_;
+                        parent_fitness_ = chromosome.parent_fitness_;
+                        changes_ = chromosome.changes_;
                     }
                     return *this;
                 }
@@ -56,6 +75,7 @@ namespace HeuristicAlgorithm
                 {
                     genes_ = __il;
                     fitness_.reset();
+                    clearChanges();
                     return *this;
                 }
 
@@ -64,15 +84,20 @@ namespace HeuristicAlgorithm
                 {
                     genes_ = std::move(genes);
                     fitness_.reset();
+                    clearChanges();
                     return *this;
                 }
-                Chromosome(Chromosome_ &&chromosome) : genes_(std::move(chromosome.genes_)), fitness_(std::move(chromosome.fitness_)) {}
+                Chromosome(Chromosome_ &&chromosome) :
+                    genes_(std::move(chromosome.genes_)), fitness_(std::move(chromosome.fitness_)),
+                    parent_fitness_(std::move(chromosome.parent_fitness_)), changes_(std::move(chromosome.changes_)) {}
                 Chromosome_ &operator=(Chromosome_ &&chromosome)
                 {
                     if (this != &chromosome)
                     {
                         genes_ = std::move(chromosome.genes_);
                         fitness_ = std::move(chromosome.fitness_);
+                        parent_fitness_ = std::move(chromosome.parent_fitness_);
+                        changes_ = std::move(chromosome.changes_);
                     }
                     return *this;
                 }
@@ -80,6 +105,7 @@ namespace HeuristicAlgorithm
                 Genes_ &get()
                 {
                     fitness_.reset();
+                    clearChanges();
                     return genes_;
                 }
                 const Genes_ &get() const { return genes_; }
@@ -88,9 +114,76 @@ namespace HeuristicAlgorithm
                 std::optional<FitnessType> &getFitness() { return fitness_; }
                 const std::optional<FitnessType> &getFitness() const { return fitness_; }
 
+                // Reference to a gene that writes through changeGene.
+                class GeneReference
+                {
+                public:
+                    GeneReference(Chromosome_ &chromosome, size_t ind) : chromosome_(chromosome), ind_(ind) {}
+
+                    operator GeneType() const { return chromosome_.cget()[ind_]; }
+                    GeneReference &operator=(const GeneType &value)
+                    {
+                        chromosome_.changeGene(ind_, value);
+                        return *this;
+                    }
+                    GeneReference &operator=(const GeneReference &other) { return *this = GeneType(other); }
+
+                protected:
+                    Chromosome_ &chromosome_;
+                    size_t ind_;
+                };
+
+                // Mutable view of the genes, unlike get() it keeps the fitness until a gene actually changes.
+                class GenesView
+                {
+                public:
+                    GenesView(Chromosome_ &chromosome) : chromosome_(chromosome) {}
+
+                    GeneReference operator[](size_t ind) { return GeneReference(chromosome_, ind); }
+                    GeneType operator[](size_t ind) const { return chromosome_.cget()[ind]; }
+                    size_t size() const { return chromosome_.cget().size(); }
+
+                protected:
+                    Chromosome_ &chromosome_;
+                };
+
+                GenesView genes() { return GenesView(*this); }
+
+                // Sets a gene and records (index, old value) relative to the last known fitness,
+                // which becomes the parent fitness for IncrementalFitnessFunctionWrapper.
+                // Writing the same value keeps the fitness.
+                void changeGene(size_t ind, const GeneType &value)
+                {
+                    if (GeneType(genes_[ind]) == value)
+                    {
+                        return;
+                    }
+                    if (fitness_.has_value())
+                    {
+                        parent_fitness_ = fitness_;
+                        fitness_.reset();
+                        changes_.clear();
+                    }
+                    if (parent_fitness_.has_value())
+                    {
+                        changes_.emplace_back(ind, GeneType(genes_[ind]));
+                    }
+                    genes_[ind] = value;
+                }
+
+                const std::optional<FitnessType> &getParentFitness() const { return parent_fitness_; }
+                const Changes_ &getChanges() const { return changes_; }
+                void clearChanges()
+                {
+                    parent_fitness_.reset();
+                    changes_.clear();
+                }
+
             protected:
                 Genes_ genes_;
                 std::optional<FitnessType> fitness_;
+                std::optional<FitnessType> parent_fitness_;
+                Changes_ changes_;
             };
 
             template <class GeneType, class FitnessType, size_t num_genes>
@@ -361,7 +454,11 @@ namespace HeuristicAlgorithm
                 }
 
                 StatPopulation(StatGenerations_ &&stat_generations) : stat_generations_(std::move(stat_generations)) {}
-                StatPopulation_ &operator=(StatGenerations_ &&stat_generations) { stat_generations_ = std::move(stat_generations); }
+                StatPopulation_ &operator=(StatGenerations_ &&stat_generations)
+                {
+                    stat_generations_ = std::move(stat_generations);
+                    return *this;
+                }
                 StatPopulation(StatPopulation_ &&stat_population) : stat_generations_(std::move(stat_population.stat_generations_)) {}
                 StatPopulation_ &operator=(StatPopulation_ &&stat_population)
                 {
@@ -372,6 +469,9 @@ namespace HeuristicAlgorithm
                     return *this;
                 }
 
+                StatGenerations_ &get() { return stat_generations_; }
+                const StatGenerations_ &get() const { return stat_generations_; }
+
             protected:
                 StatGenerations_ stat_generations_;
             };
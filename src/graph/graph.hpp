@@ -1,6 +1,7 @@
 #pragma once
 
 #include "node.hpp"
+#include "../tools/cancellation.hpp"
 
 #include <unordered_map>
 #include <memory>
@@ -9,7 +10,8 @@
 #include <stack>
 #include <string>
 #include <unordered_set>
-#include <queue>
+#include <deque>
+#include <functional>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -29,6 +31,8 @@ namespace HeuristicAlgorithm
             completed
         };
 
+        // Readiness is an atomic count of unfinished predecessors: every edge writes its input into its own slot
+        // and then decrements the count, the predecessor that brings it to zero queues the task, exactly once and without locks.
         template<class SerializationType>
         struct NodeTask
         {
@@ -37,63 +41,81 @@ namespace HeuristicAlgorithm
 
             NodeTask(std::shared_ptr<BaseNode_> task): task_(task), status_(NodeTaskStatus::not_in_q) {}
 
-            void add_dep(std::shared_ptr<NodeTask_> pref_task)
+            // Returns the input slot of the edge from pref_task, only before the graph runs.
+            size_t add_dep(std::shared_ptr<NodeTask_> pref_task)
             {
                 if (dependencies_.find(pref_task->task_->id_) != dependencies_.end())
                 {
                     std::__throw_logic_error("duplicate dependencies");
                 }
-                dependencies_[pref_task->task_->id_] = pref_task;
+                size_t slot = inputs_.size();
+                dependencies_[pref_task->task_->id_] = slot;
+                inputs_.emplace_back();
+                ++remaining_deps_;
+                return slot;
             }
 
-            void add_next(std::shared_ptr<NodeTask_> next_task)
+            void add_next(std::shared_ptr<NodeTask_> next_task, size_t slot)
             {
-                next_nodes_.push_back(next_task);
+                next_nodes_.push_back({next_task, slot});
             }
 
-            void rem_dep(const std::string& node, SerializationType& ser_data)
+            // Returns true for the last predecessor, which must queue the task.
+            bool rem_dep(size_t slot, SerializationType ser_data)
             {
-                dependencies_.erase(node);
-                inputs_.push_back(ser_data);
+                inputs_[slot] = std::move(ser_data);
+                return remaining_deps_.fetch_sub(1, std::memory_order_acq_rel) == 1;
             }
 
+            bool is_ready() const { return remaining_deps_.load(std::memory_order_acquire) == 0; }
+
             SerializationType calc()
             {
-                if (!dependencies_.empty())
+                if (!is_ready())
                 {
                     std::__throw_logic_error("unresolved dependencies");
                 }
                 return task_->evolution(inputs_);
             }
 
-            std::unordered_map<std::string, std::shared_ptr<NodeTask_>> dependencies_;
-            std::vector<std::shared_ptr<NodeTask_>> next_nodes_;
+            struct NextNode_
+            {
+                std::shared_ptr<NodeTask_> task_;
+                size_t slot_;
+            };
+
+            // predecessor id -> input slot
+            std::unordered_map<std::string, size_t> dependencies_;
+            std::vector<NextNode_> next_nodes_;
+            // in the order the edges were added
             std::vector<SerializationType> inputs_;
+            std::atomic<size_t> remaining_deps_{ 0 };
             std::shared_ptr<BaseNode_> task_;
-            NodeTaskStatus status_;
+            std::atomic<NodeTaskStatus> status_;
         };
 
+        // Work-stealing pool: every worker owns a deque, runs its newest task first and pushes ready successors
+        // to its own deque, an idle worker steals the oldest task of another worker and sleeps only when all deques are empty.
         template<class SerializationType>
         struct ThreadPool 
         {
             using BaseNode_ = BaseNode<SerializationType>;
             using NodeTask_ = NodeTask<SerializationType>;
 
-            ThreadPool(const size_t num_threads) 
+            ThreadPool(const size_t num_threads, std::shared_ptr<Tools::CancellationToken> cancellation_token = nullptr):
+                queues_(std::max<size_t>(1, num_threads)), cancellation_token_(cancellation_token)
             {
-                threads_.reserve(num_threads);
-                for (int i = 0; i < num_threads; ++i) 
+                threads_.reserve(queues_.size());
+                for (size_t i = 0; i < queues_.size(); ++i) 
                 {
-                    threads_.emplace_back(&ThreadPool::run, this);
+                    threads_.emplace_back(&ThreadPool::run, this, i);
                 }
             }
 
+            // Tasks from outside the pool are spread over the workers round-robin.
             void add_task(std::shared_ptr<NodeTask_> task) 
             {
-                last_idx_++;
-                std::lock_guard<std::mutex> q_lock(q_mtx_);
-                q_.emplace(task);
-                q_cv_.notify_one();
+                push_(next_queue_++ % queues_.size(), std::move(task));
             }
 
             void wait_all() 
@@ -104,47 +126,114 @@ namespace HeuristicAlgorithm
 
             ~ThreadPool() 
             {
-                quite_ = true;
-                q_cv_.notify_all();
-                for (int i = 0; i < threads_.size(); ++i) {
-                    threads_[i].join();
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mtx_);
+                    quite_ = true;
+                }
+                sleep_cv_.notify_all();
+                for (auto& thread: threads_)
+                {
+                    thread.join();
                 }
             }
 
-            void run() {
+            void run(size_t worker) {
                 while (!quite_) {
-                    std::unique_lock<std::mutex> lock(q_mtx_);
-                    q_cv_.wait(lock, [this]()->bool { return !q_.empty() || quite_; });
-
-                    if (!q_.empty() && !quite_) {
-                        std::shared_ptr<NodeTask_> task = std::move(q_.front());
-                        q_.pop();
-                        task->status_ = NodeTaskStatus::in_q;
-                        lock.unlock();
+                    std::shared_ptr<NodeTask_> task = pop_(worker);
+                    if (!task)
+                    {
+                        std::unique_lock<std::mutex> lock(sleep_mtx_);
+                        ++cnt_sleeping_;
+                        sleep_cv_.wait(lock, [this]()->bool { return cnt_queued_ > 0 || quite_; });
+                        --cnt_sleeping_;
+                        continue;
+                    }
+                    task->status_ = NodeTaskStatus::in_q;
 
+                    // a cancelled graph does not start new nodes, their successors are never queued
+                    if (!cancellation_token_ || !cancellation_token_->isCancelled())
+                    {
                         auto res = task->calc();
-
-                        ++cnt_completed_tasks_;
-                        task->status_ = NodeTaskStatus::completed;
-
-                        for (std::shared_ptr<NodeTask_> next_task: task->next_nodes_)
+                        for (size_t i = 0; i < task->next_nodes_.size(); ++i)
                         {
-                            next_task->rem_dep(task->task_->id_, res);
-                            if (next_task->status_ == NodeTaskStatus::not_in_q && next_task->dependencies_.empty())
+                            auto& next = task->next_nodes_[i];
+                            bool is_last = i + 1 == task->next_nodes_.size();
+                            if (next.task_->rem_dep(next.slot_, is_last ? std::move(res) : res))
                             {
-                                add_task(next_task);
+                                push_(worker, next.task_);
                             }
                         }
                     }
-                    wait_all_cv_.notify_all();
+                    task->status_ = NodeTaskStatus::completed;
+
+                    // successors are counted before the task is, so wait_all cannot see a finished graph too early
+                    if (++cnt_completed_tasks_ == last_idx_)
+                    {
+                        std::lock_guard<std::mutex> lock(tasks_info_mtx_);
+                        wait_all_cv_.notify_all();
+                    }
                 }
             }
 
+        protected:
+            struct WorkerQueue_
+            {
+                std::mutex mtx_;
+                std::deque<std::shared_ptr<NodeTask_>> tasks_;
+            };
+
+            void push_(size_t worker, std::shared_ptr<NodeTask_> task)
+            {
+                ++last_idx_;
+                {
+                    std::lock_guard<std::mutex> lock(queues_[worker].mtx_);
+                    queues_[worker].tasks_.push_back(std::move(task));
+                }
+                ++cnt_queued_;
+                if (cnt_sleeping_ > 0)
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mtx_);
+                    sleep_cv_.notify_one();
+                }
+            }
+
+            std::shared_ptr<NodeTask_> pop_(size_t worker)
+            {
+                std::shared_ptr<NodeTask_> task;
+                for (size_t i = 0; i < queues_.size() && !task; ++i)
+                {
+                    WorkerQueue_& queue = queues_[(worker + i) % queues_.size()];
+                    std::lock_guard<std::mutex> lock(queue.mtx_);
+                    if (queue.tasks_.empty())
+                    {
+                        continue;
+                    }
+                    if (i == 0)
+                    {
+                        task = std::move(queue.tasks_.back());
+                        queue.tasks_.pop_back();
+                    }
+                    else
+                    {
+                        task = std::move(queue.tasks_.front());
+                        queue.tasks_.pop_front();
+                    }
+                }
+                if (task)
+                {
+                    --cnt_queued_;
+                }
+                return task;
+            }
+
+            std::vector<WorkerQueue_> queues_;
             std::vector<std::thread> threads_;
 
-            std::queue<std::shared_ptr<NodeTask_>> q_;
-            std::mutex q_mtx_;
-            std::condition_variable q_cv_;
+            std::mutex sleep_mtx_;
+            std::condition_variable sleep_cv_;
+            std::atomic<size_t> cnt_sleeping_{ 0 };
+            std::atomic<size_t> cnt_queued_{ 0 };
+            std::atomic<size_t> next_queue_{ 0 };
             
             std::mutex tasks_info_mtx_;
 
@@ -153,6 +242,8 @@ namespace HeuristicAlgorithm
             std::atomic<bool> quite_{ false };
             std::atomic<uint64_t> last_idx_{ 0 };
             std::atomic<uint64_t> cnt_completed_tasks_{ 0 };
+
+            std::shared_ptr<Tools::CancellationToken> cancellation_token_;
         };
 
 
@@ -184,10 +275,14 @@ namespace HeuristicAlgorithm
                 adj_list_[from_node].push_back(to_node);
             }
 
+            // Nodes that have not started when the token is cancelled are skipped,
+            // running nodes stop if their algorithms observe the same token.
+            void setCancellationToken(std::shared_ptr<Tools::CancellationToken> token) { cancellation_token_ = token; }
+
             void evolution(size_t num_threads = 1)
             {
                 auto sorted_nodes = top_sort();
-                ThreadPool<SerializationType> tp(num_threads);
+                ThreadPool<SerializationType> tp(num_threads, cancellation_token_);
                 std::unordered_map<std::string, std::shared_ptr<NodeTask<SerializationType>>> node_tasks;
                 for (auto& [node, _]: sorted_nodes)
                 {
@@ -197,17 +292,23 @@ namespace HeuristicAlgorithm
                 {
                     for (auto& next_node: adj_list_[node])
                     {
-                        node_tasks[node]->add_next(node_tasks[next_node]);
-                        node_tasks[next_node]->add_dep(node_tasks[node]);
+                        size_t slot = node_tasks[next_node]->add_dep(node_tasks[node]);
+                        node_tasks[node]->add_next(node_tasks[next_node], slot);
                     }
                 }
+                // sources are collected first: workers change the counters of other nodes as soon as they start
+                std::vector<std::shared_ptr<NodeTask<SerializationType>>> sources;
                 for (auto& [node, _]: sorted_nodes)
                 {
-                    if (node_tasks[node]->dependencies_.empty() && node_tasks[node]->status_ == NodeTaskStatus::not_in_q)
+                    if (node_tasks[node]->is_ready())
                     {
-                        tp.add_task(node_tasks[node]);
+                        sources.push_back(node_tasks[node]);
                     }
                 }
+                for (auto& source: sources)
+                {
+                    tp.add_task(source);
+                }
                 tp.wait_all();
             }
 
@@ -261,6 +362,7 @@ namespace HeuristicAlgorithm
             
             std::unordered_map<std::string, std::shared_ptr<BaseNode_>> nodes_;
             std::unordered_map<std::string, std::vector<std::string>> adj_list_;
+            std::shared_ptr<Tools::CancellationToken> cancellation_token_;
         };
     }
 }
\ No newline at end of file
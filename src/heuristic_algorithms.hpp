@@ -1,4 +1,11 @@
 #pragma once
 
 #include "graph/graph.hpp"
-#include "genetic_algorithm/genetic_algorithm.hpp"
\ No newline at end of file
+#include "genetic_algorithm/genetic_algorithm.hpp"
+#include "genetic_algorithm/stat_genetic_algorithm.hpp"
+#include "genetic_algorithm/policy_genetic_algorithm.hpp"
+#include "genetic_algorithm/island_genetic_algorithm.hpp"
+#include "genetic_algorithm/dense_generation.hpp"
+#include "genetic_algorithm/steady_state_genetic_algorithm.hpp"
+#include "genetic_algorithm/operators.hpp"
+#include "genetic_algorithm/checkpoint.hpp"
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "random.hpp"
+
+#include <vector>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        // Walker / Vose alias table: O(n) construction, O(1) sampling of an index with probability proportional to its weight.
+        class AliasTable
+        {
+        public:
+            AliasTable() {}
+            template <class Iterator>
+            AliasTable(Iterator first, Iterator last) { assign(first, last); }
+
+            // Weights must be non-negative, all zero weights give the uniform distribution. Buffers are reused between calls.
+            template <class Iterator>
+            void assign(Iterator first, Iterator last)
+            {
+                probability_.clear();
+                double sum = 0.;
+                for (; first != last; ++first)
+                {
+                    double weight = static_cast<double>(*first);
+                    if (!(weight >= 0.)) {std::__throw_logic_error("alias table weights must be non-negative");}
+                    probability_.push_back(weight);
+                    sum += weight;
+                }
+                size_t n = probability_.size();
+                alias_.resize(n);
+                small_.clear();
+                large_.clear();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    probability_[i] = sum > 0. ? probability_[i] * n / sum : 1.;
+                    alias_[i] = i;
+                    (probability_[i] < 1. ? small_ : large_).push_back(i);
+                }
+                while (!small_.empty() && !large_.empty())
+                {
+                    size_t less = small_.back();
+                    small_.pop_back();
+                    size_t more = large_.back();
+                    alias_[less] = more;
+                    probability_[more] -= 1. - probability_[less];
+                    if (probability_[more] < 1.)
+                    {
+                        large_.pop_back();
+                        small_.push_back(more);
+                    }
+                }
+                // leftovers are 1 up to rounding
+                for (size_t i: small_)
+                {
+                    probability_[i] = 1.;
+                }
+                for (size_t i: large_)
+                {
+                    probability_[i] = 1.;
+                }
+            }
+
+            size_t operator()(Random &random) const
+            {
+                size_t ind = random.uniformInt(probability_.size());
+                return random.uniformReal() < probability_[ind] ? ind : alias_[ind];
+            }
+
+            size_t size() const { return probability_.size(); }
+            bool empty() const { return probability_.empty(); }
+
+        protected:
+            std::vector<double> probability_;
+            std::vector<size_t> alias_;
+            std::vector<size_t> small_;
+            std::vector<size_t> large_;
+        };
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        // Cooperative stop request: cancel() from any thread or a deadline on the steady clock.
+        // Long computations poll isCancelled() and return whatever they have.
+        // A token with a parent is cancelled together with the parent.
+        class CancellationToken
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            explicit CancellationToken(std::shared_ptr<const CancellationToken> parent = nullptr): parent_(std::move(parent)) {}
+            explicit CancellationToken(Clock::duration timeout, std::shared_ptr<const CancellationToken> parent = nullptr): parent_(std::move(parent))
+            {
+                setTimeout(timeout);
+            }
+
+            CancellationToken(const CancellationToken&) = delete;
+            CancellationToken& operator=(const CancellationToken&) = delete;
+
+            void cancel() { is_cancelled_.store(true, std::memory_order_release); }
+            void setDeadline(Clock::time_point deadline) { deadline_.store(deadline.time_since_epoch().count(), std::memory_order_release); }
+            void setTimeout(Clock::duration timeout) { setDeadline(Clock::now() + timeout); }
+            // Clears cancel() and the deadline, the parent is kept.
+            void reset()
+            {
+                is_cancelled_.store(false, std::memory_order_release);
+                deadline_.store(no_deadline_, std::memory_order_release);
+            }
+
+            Clock::time_point getDeadline() const { return Clock::time_point(Clock::duration(deadline_.load(std::memory_order_acquire))); }
+
+            // One atomic load when nothing is set, a clock read when a deadline is set.
+            bool isCancelled() const
+            {
+                if (is_cancelled_.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+                Clock::rep deadline = deadline_.load(std::memory_order_acquire);
+                if (deadline != no_deadline_ && Clock::now().time_since_epoch().count() >= deadline)
+                {
+                    return true;
+                }
+                return parent_ && parent_->isCancelled();
+            }
+
+        protected:
+            static constexpr Clock::rep no_deadline_ = std::numeric_limits<Clock::rep>::max();
+
+            std::atomic<bool> is_cancelled_{ false };
+            std::atomic<Clock::rep> deadline_{ no_deadline_ };
+            std::shared_ptr<const CancellationToken> parent_;
+        };
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        // Streaming statistics of durations: count, total, min, max and quantiles.
+        // Quantiles come from a log-scale histogram with 8 buckets per power of two, so they are within 12.5%.
+        class DurationStats
+        {
+        public:
+            using Duration = std::chrono::nanoseconds;
+
+            void add(Duration duration)
+            {
+                uint64_t value = duration.count() > 0 ? duration.count() : 0;
+                ++count_;
+                total_ += value;
+                min_ = std::min(min_, value);
+                max_ = std::max(max_, value);
+                ++buckets_[bucket_(value)];
+            }
+
+            void clear() { *this = DurationStats(); }
+
+            size_t count() const { return count_; }
+            Duration total() const { return Duration(total_); }
+            Duration min() const { return Duration(count_ ? min_ : 0); }
+            Duration max() const { return Duration(max_); }
+            Duration mean() const { return Duration(count_ ? total_ / count_ : 0); }
+
+            // q in [0, 1], e.g. 0.99 for p99
+            Duration quantile(double q) const
+            {
+                if (count_ == 0)
+                {
+                    return Duration(0);
+                }
+                uint64_t rank = std::max<uint64_t>(1, std::min<uint64_t>(count_, uint64_t(q * count_ + 0.5)));
+                uint64_t seen = 0;
+                for (size_t i = 0; i < num_buckets_; ++i)
+                {
+                    seen += buckets_[i];
+                    if (seen >= rank)
+                    {
+                        return Duration(std::clamp(bucket_middle_(i), min_, max_));
+                    }
+                }
+                return Duration(max_);
+            }
+
+        protected:
+            static constexpr size_t sub_bits_ = 3;
+            static constexpr size_t num_sub_ = size_t(1) << sub_bits_;
+            static constexpr size_t num_buckets_ = num_sub_ + (64 - sub_bits_) * num_sub_;
+
+            // values below num_sub_ get exact buckets, then num_sub_ buckets per power of two
+            static size_t bucket_(uint64_t value)
+            {
+                if (value < num_sub_)
+                {
+                    return value;
+                }
+                size_t power = floor_log2_(value);
+                return num_sub_ + (power - sub_bits_) * num_sub_ + ((value >> (power - sub_bits_)) & (num_sub_ - 1));
+            }
+
+            static size_t floor_log2_(uint64_t value)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return 63 - __builtin_clzll(value);
+#else
+                size_t res = 0;
+                while (value >>= 1) { ++res; }
+                return res;
+#endif
+            }
+
+            static uint64_t bucket_middle_(size_t bucket)
+            {
+                if (bucket < num_sub_)
+                {
+                    return bucket;
+                }
+                size_t power = (bucket - num_sub_) / num_sub_ + sub_bits_;
+                uint64_t width = uint64_t(1) << (power - sub_bits_);
+                uint64_t lower = (uint64_t(1) << power) + ((bucket - num_sub_) % num_sub_) * width;
+                return lower + width / 2;
+            }
+
+            uint64_t count_ = 0;
+            uint64_t total_ = 0;
+            uint64_t min_ = std::numeric_limits<uint64_t>::max();
+            uint64_t max_ = 0;
+            std::array<uint64_t, num_buckets_> buckets_ = {};
+        };
+    }
+}
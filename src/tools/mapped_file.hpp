@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HEURISTIC_ALGORITHM_MMAP
+#endif
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        // Read-only contents of a whole file: mmap on POSIX, read into a buffer elsewhere or if mapping fails.
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string& path)
+            {
+#ifdef HEURISTIC_ALGORITHM_MMAP
+                if (map_(path))
+                {
+                    return;
+                }
+#endif
+                std::ifstream in(path, std::ios::binary);
+                if (!in)
+                {
+                    std::__throw_runtime_error(("cannot open \"" + path + "\"").c_str());
+                }
+                buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                data_ = buffer_.data();
+                size_ = buffer_.size();
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            ~MappedFile()
+            {
+#ifdef HEURISTIC_ALGORITHM_MMAP
+                if (is_mapped_)
+                {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+#endif
+            }
+
+            const char* data() const { return data_; }
+            size_t size() const { return size_; }
+
+        protected:
+#ifdef HEURISTIC_ALGORITHM_MMAP
+            bool map_(const std::string& path)
+            {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    return false;
+                }
+                struct stat file_stat;
+                if (::fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                void* addr = ::mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if (addr == MAP_FAILED)
+                {
+                    return false;
+                }
+                ::madvise(addr, file_stat.st_size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(addr);
+                size_ = file_stat.st_size;
+                is_mapped_ = true;
+                return true;
+            }
+#endif
+
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+            bool is_mapped_ = false;
+            std::vector<char> buffer_;
+        };
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        // xoshiro256** generator, satisfies UniformRandomBitGenerator so it also works with <random> distributions.
+        // Independent reproducible streams are derived with split(stream).
+        class Random
+        {
+        public:
+            using result_type = uint64_t;
+
+            explicit Random(uint64_t seed = 0)
+            {
+                for (auto& word: state_)
+                {
+                    word = splitmix64_(seed);
+                }
+            }
+
+            using State = std::array<uint64_t, 4>;
+
+            // Raw generator state, for checkpoints.
+            const State& getState() const { return state_; }
+            void setState(const State& state) { state_ = state; }
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            result_type operator()()
+            {
+                uint64_t res = rotl_(state_[1] * 5, 7) * 9;
+                uint64_t t = state_[1] << 17;
+                state_[2] ^= state_[0];
+                state_[3] ^= state_[1];
+                state_[1] ^= state_[2];
+                state_[0] ^= state_[3];
+                state_[2] ^= t;
+                state_[3] = rotl_(state_[3], 45);
+                return res;
+            }
+
+            // Generator of the stream-th substream, depends only on the current state and stream.
+            Random split(uint64_t stream) const
+            {
+                uint64_t seed = stream;
+                uint64_t key = splitmix64_(seed);
+                for (uint64_t word: state_)
+                {
+                    uint64_t mixed = word ^ key;
+                    key = splitmix64_(mixed);
+                }
+                return Random(key);
+            }
+
+            // Uniform integer in [0, bound), bound > 0.
+            uint64_t uniformInt(uint64_t bound)
+            {
+                uint64_t low;
+                uint64_t high = mul_wide_((*this)(), bound, low);
+                if (low < bound)
+                {
+                    uint64_t threshold = -bound % bound;
+                    while (low < threshold)
+                    {
+                        high = mul_wide_((*this)(), bound, low);
+                    }
+                }
+                return high;
+            }
+
+            // Uniform integer in [first, last].
+            int64_t uniformInt(int64_t first, int64_t last)
+            {
+                uint64_t range = (uint64_t)last - (uint64_t)first + 1;
+                if (range == 0)
+                {
+                    return (int64_t)(*this)();
+                }
+                return first + (int64_t)uniformInt(range);
+            }
+
+            // Uniform real in [0, 1).
+            double uniformReal() { return ((*this)() >> 11) * 0x1.0p-53; }
+            double uniformReal(double first, double last) { return first + (last - first) * uniformReal(); }
+
+            bool bernoulli(double probability) { return uniformReal() < probability; }
+
+            // Number of failures before the first success of Bernoulli(probability) trials.
+            uint64_t geometric(double probability)
+            {
+                if (probability >= 1.)
+                {
+                    return 0;
+                }
+                return geometric_(std::log1p(-probability));
+            }
+
+            // Calls fun(ind) for every success among num_trials Bernoulli(probability) trials in increasing order,
+            // jumping over the failures, so the cost is proportional to the number of successes.
+            template <class Function>
+            void forEachSuccess(size_t num_trials, double probability, Function &&fun)
+            {
+                if (probability <= 0.)
+                {
+                    return;
+                }
+                if (probability >= 1.)
+                {
+                    for (size_t i = 0; i < num_trials; ++i)
+                    {
+                        fun(i);
+                    }
+                    return;
+                }
+                double log_failure = std::log1p(-probability);
+                for (uint64_t i = geometric_(log_failure); i < num_trials; i += 1 + geometric_(log_failure))
+                {
+                    fun(i);
+                }
+            }
+
+        protected:
+            uint64_t geometric_(double log_failure)
+            {
+                double gap = std::floor(std::log(1. - uniformReal()) / log_failure);
+                return gap < 0x1.0p63 ? (uint64_t)gap : (uint64_t(1) << 63);
+            }
+
+            static uint64_t rotl_(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+            // High 64 bits of the 128-bit product, the low ones go to low.
+            static uint64_t mul_wide_(uint64_t a, uint64_t b, uint64_t& low)
+            {
+#if defined(__SIZEOF_INT128__)
+                unsigned __int128 product = (unsigned __int128)a * b;
+                low = (uint64_t)product;
+                return product >> 64;
+#elif defined(_MSC_VER) && defined(_M_X64)
+                uint64_t high;
+                low = _umul128(a, b, &high);
+                return high;
+#else
+                uint64_t a_low = a & 0xffffffffULL, a_high = a >> 32;
+                uint64_t b_low = b & 0xffffffffULL, b_high = b >> 32;
+                uint64_t low_low = a_low * b_low;
+                uint64_t high_low = a_high * b_low;
+                uint64_t low_high = a_low * b_high;
+                uint64_t middle = (low_low >> 32) + (high_low & 0xffffffffULL) + (low_high & 0xffffffffULL);
+                low = (middle << 32) | (low_low & 0xffffffffULL);
+                return a_high * b_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+#endif
+            }
+
+            static uint64_t splitmix64_(uint64_t& x)
+            {
+                uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                return z ^ (z >> 31);
+            }
+
+            State state_;
+        };
+    }
+}
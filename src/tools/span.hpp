@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        template<class Type>
+        class Span
+        {
+        public:
+            using value_type = Type;
+            using iterator = Type*;
+            using const_iterator = const Type*;
+
+            Span(): data_(nullptr), size_(0) {}
+            Span(Type* data, size_t size): data_(data), size_(size) {}
+            Span(Type* first, Type* last): data_(first), size_(last - first) {}
+
+            Type& operator[](size_t ind) const { return data_[ind]; }
+            Type& at(size_t ind) const
+            {
+                if (ind >= size_) {std::__throw_out_of_range("Span");}
+                return data_[ind];
+            }
+
+            Span subspan(size_t offset, size_t count) const
+            {
+                if (offset + count > size_) {std::__throw_out_of_range("Span");}
+                return Span(data_ + offset, count);
+            }
+
+            Type* data() const { return data_; }
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+
+            iterator begin() const { return data_; }
+            iterator end() const { return data_ + size_; }
+
+        protected:
+            Type* data_;
+            size_t size_;
+        };
+    }
+}
@@ -2,16 +2,63 @@
 
 #include <array>
 #include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 
 namespace HeuristicAlgorithm
 {
     namespace GeneticAlgorithm
     {
+        // Random access iterator over a suffix from the newest element ([0]) to the oldest one.
+        template<class Container, class Reference>
+        class SuffixIterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_cv_t<std::remove_reference_t<Reference>>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::remove_reference_t<Reference>*;
+            using reference = Reference;
+
+            SuffixIterator(): container_(nullptr), ind_(0) {}
+            SuffixIterator(Container* container, size_t ind): container_(container), ind_(ind) {}
+
+            Reference operator*() const {return container_->at_(ind_);}
+            pointer operator->() const {return &container_->at_(ind_);}
+            Reference operator[](difference_type shift) const {return container_->at_(ind_ + shift);}
+
+            SuffixIterator& operator++() {++ind_; return *this;}
+            SuffixIterator operator++(int) {SuffixIterator res = *this; ++ind_; return res;}
+            SuffixIterator& operator--() {--ind_; return *this;}
+            SuffixIterator operator--(int) {SuffixIterator res = *this; --ind_; return res;}
+            SuffixIterator& operator+=(difference_type shift) {ind_ += shift; return *this;}
+            SuffixIterator& operator-=(difference_type shift) {ind_ -= shift; return *this;}
+            SuffixIterator operator+(difference_type shift) const {return SuffixIterator(container_, ind_ + shift);}
+            SuffixIterator operator-(difference_type shift) const {return SuffixIterator(container_, ind_ - shift);}
+            difference_type operator-(const SuffixIterator& other) const {return difference_type(ind_) - difference_type(other.ind_);}
+
+            bool operator==(const SuffixIterator& other) const {return ind_ == other.ind_;}
+            bool operator!=(const SuffixIterator& other) const {return ind_ != other.ind_;}
+            bool operator<(const SuffixIterator& other) const {return ind_ < other.ind_;}
+            bool operator>(const SuffixIterator& other) const {return ind_ > other.ind_;}
+            bool operator<=(const SuffixIterator& other) const {return ind_ <= other.ind_;}
+            bool operator>=(const SuffixIterator& other) const {return ind_ >= other.ind_;}
+
+        protected:
+            Container* container_;
+            size_t ind_;
+        };
+
+
+        // Ring of the last capacity pushed elements, [0] is the newest one. size() counts all pushes.
+        // Indexing needs no division: a mask for power-of-two capacities, one conditional subtraction otherwise.
         template<class Type>
         class Suffix
         {
-            void __zero_capacity_error() const 
+            void __zero_capacity_error() const
             {if (capacity_ == 0) {std::__throw_logic_error("capacity must be greater than 0");}}
 
             void __smaller_container_error() const
@@ -23,72 +70,107 @@ namespace HeuristicAlgorithm
             void __constructor_error() const
             {__zero_capacity_error(); __smaller_container_error(); __invalid_start_ind_error();}
 
+            template<class Container, class Reference>
+            friend class SuffixIterator;
+
         public:
             using SuffixData_ = std::vector<Type>;
             using Suffix_ = Suffix<Type>;
 
-            Suffix(): size_(0), start_(0), capacity_(1), suffix_data_(1) {}
-            Suffix(size_t capacity): size_(0), start_(0), capacity_(capacity), suffix_data_(capacity) 
-            {__constructor_error();}
+            using value_type = Type;
+            using iterator = SuffixIterator<Suffix_, Type&>;
+            using const_iterator = SuffixIterator<const Suffix_, const Type&>;
 
-            Suffix(const SuffixData_& suff_data, size_t capacity, size_t start = 0): size_(suff_data.size()), start_(start), capacity_(capacity), suffix_data_(suff_data) 
-            {__constructor_error();}
-            Suffix(SuffixData_&& suff_data, size_t capacity, size_t start = 0): size_(suff_data.size()), start_(start), capacity_(capacity), suffix_data_(std::move(suff_data)) 
+            Suffix(): capacity_(1), mask_(0), size_(0), start_(0), suffix_data_(1) {}
+            Suffix(size_t capacity): capacity_(capacity), mask_(mask_of_(capacity)), size_(0), start_(0), suffix_data_(capacity)
             {__constructor_error();}
 
-            Suffix(const Suffix_& suff): size_(suff.size_), start_(suff.start_), capacity_(suff.capacity_), suffix_data_(suff.suffix_data_) {}
-            Suffix_& operator=(const Suffix_& suff)
-            {
-                if (this != &suff) 
-                {
-                    size_ = suff.size_;
-                    start_ = suff.start_;
-                    capacity_ = suff.capacity_;
-                    suffix_data_ = suff.suffix_data_;
-                }
-                return *this;
-            }
-            Suffix(Suffix_&& suff): size_(suff.size_), start_(suff.start_), capacity_(suff.capacity_), suffix_data_(std::move(suff.suffix_data_)) {}
-            Suffix_& operator=(Suffix_&& suff)
+            Suffix(const SuffixData_& suff_data, size_t capacity, size_t start = 0):
+                capacity_(capacity), mask_(mask_of_(capacity)), size_(suff_data.size()), start_(start), suffix_data_(suff_data)
+            {__constructor_error(); suffix_data_.resize(capacity_);}
+            Suffix(SuffixData_&& suff_data, size_t capacity, size_t start = 0):
+                capacity_(capacity), mask_(mask_of_(capacity)), size_(suff_data.size()), start_(start), suffix_data_(std::move(suff_data))
+            {__constructor_error(); suffix_data_.resize(capacity_);}
+            // Restores the raw state returned by data(), start() and size()
+            Suffix(SuffixData_&& suff_data, size_t capacity, size_t start, size_t size):
+                capacity_(capacity), mask_(mask_of_(capacity)), size_(size), start_(start), suffix_data_(std::move(suff_data))
             {
-                if (this != &suff)
-                {
-                    size_ = suff.size_;
-                    start_ = suff.start_;
-                    capacity_ = suff.capacity_;
-                    suffix_data_ = std::move(suff.suffix_data_);
-                }
-                return *this;
+                __constructor_error();
+                if (suffix_data_.size() != capacity_ || (size_ < capacity_ && start_ != 0)) {std::__throw_logic_error("invalid suffix state");}
             }
 
+            Suffix(const Suffix_& suff) = default;
+            Suffix_& operator=(const Suffix_& suff) = default;
+            Suffix(Suffix_&& suff) = default;
+            Suffix_& operator=(Suffix_&& suff) = default;
+
             Type& operator[](size_t ind)
             {
-                if (ind >= capacity_ || ind >= size_) {std::__throw_out_of_range("Suffix");}
-                size_t shift = std::min(capacity_, size_);
-                return suffix_data_[(capacity_ + start_ + shift - 1 - ind) % capacity_];
+                if (ind >= count()) {std::__throw_out_of_range("Suffix");}
+                return at_(ind);
             }
 
             const Type& operator[](size_t ind) const
             {
-                if (ind >= capacity_ || ind >= size_) {std::__throw_out_of_range("Suffix");}
-                size_t shift = std::min(capacity_, size_);
-                return suffix_data_[(capacity_ + start_ + shift - 1 - ind) % capacity_];
+                if (ind >= count()) {std::__throw_out_of_range("Suffix");}
+                return at_(ind);
+            }
+
+            // Only push(const&) and push_slot() reuse the buffers of the evicted element:
+            // push(const&) copy-assigns into it, push_slot() hands it back for filling in place.
+            void push(const Type& item) {push_slot() = item;}
+            // Moves item over the evicted element, its buffers are freed.
+            void push(Type&& item) {push_slot() = std::move(item);}
+            // Replaces the evicted element with Type(args...), its buffers are freed. Not for recycling: use push_slot().
+            template<class... Args>
+            Type& emplace(Args&&... args)
+            {
+                Type& slot = push_slot();
+                slot = Type(std::forward<Args>(args)...);
+                return slot;
             }
 
-            void push(Type item)
+            // Makes the slot of the oldest element the newest one and returns it with its old contents intact.
+            Type& push_slot()
             {
-                size_t shift = std::min(capacity_, size_);
-                suffix_data_[(start_ + shift) % capacity_] = std::move(item);
-                if (shift == capacity_) {(++start_) %= capacity_;}
+                size_t shift = count();
+                Type& slot = suffix_data_[wrap_(start_ + shift)];
+                if (shift == capacity_) {start_ = wrap_(start_ + 1);}
                 ++size_;
+                return slot;
             }
 
+            iterator begin() {return iterator(this, 0);}
+            iterator end() {return iterator(this, count());}
+            const_iterator begin() const {return const_iterator(this, 0);}
+            const_iterator end() const {return const_iterator(this, count());}
+            const_iterator cbegin() const {return begin();}
+            const_iterator cend() const {return end();}
+
             size_t size() const {return size_;}
+            // number of stored elements
+            size_t count() const {return std::min(capacity_, size_);}
+            bool empty() const {return size_ == 0;}
             size_t capacity() const {return capacity_;}
             size_t start() const {return start_;}
+            // All capacity slots in storage order, the oldest element is at start()
+            const SuffixData_& data() const {return suffix_data_;}
 
         protected:
+            static size_t mask_of_(size_t capacity) {return (capacity & (capacity - 1)) == 0 ? capacity - 1 : 0;}
+
+            // pos < 2 * capacity_
+            size_t wrap_(size_t pos) const
+            {
+                if (mask_ || capacity_ == 1) {return pos & mask_;}
+                return pos >= capacity_ ? pos - capacity_ : pos;
+            }
+
+            Type& at_(size_t ind) {return suffix_data_[wrap_(start_ + count() - 1 - ind)];}
+            const Type& at_(size_t ind) const {return suffix_data_[wrap_(start_ + count() - 1 - ind)];}
+
             size_t capacity_;
+            size_t mask_;
             size_t size_;
             size_t start_;
             SuffixData_ suffix_data_;
@@ -98,7 +180,7 @@ namespace HeuristicAlgorithm
         template<class Type, size_t capacity_>
         class StatSuffix
         {
-            constexpr void __zero_capacity_error() const 
+            constexpr void __zero_capacity_error() const
             {if (capacity_ == 0) {std::__throw_logic_error("capacity must be greater than 0");}}
 
             void __invalid_start_ind_error() const
@@ -107,70 +189,88 @@ namespace HeuristicAlgorithm
             void __constructor_error() const
             {__zero_capacity_error(); __invalid_start_ind_error();}
 
+            template<class Container, class Reference>
+            friend class SuffixIterator;
+
         public:
             using StatSuffixData_ = std::array<Type, capacity_>;
             using StatSuffix_ = StatSuffix<Type, capacity_>;
 
+            using value_type = Type;
+            using iterator = SuffixIterator<StatSuffix_, Type&>;
+            using const_iterator = SuffixIterator<const StatSuffix_, const Type&>;
+
             StatSuffix(): size_(0), start_(0) {}
 
-            StatSuffix(const StatSuffixData_& stat_suff_data, size_t start = 0): size_(capacity_), start_(start), stat_suffix_data_(stat_suff_data) 
+            StatSuffix(const StatSuffixData_& stat_suff_data, size_t start = 0): size_(capacity_), start_(start), stat_suffix_data_(stat_suff_data)
             {__constructor_error();}
-            StatSuffix(StatSuffixData_&& stat_suff_data, size_t start = 0): size_(capacity_), start_(start), stat_suffix_data_(std::move(stat_suff_data)) 
+            StatSuffix(StatSuffixData_&& stat_suff_data, size_t start = 0): size_(capacity_), start_(start), stat_suffix_data_(std::move(stat_suff_data))
             {__constructor_error();}
 
-            StatSuffix(const StatSuffix_& stat_suff): size_(stat_suff.size_), start_(stat_suff.start_), stat_suffix_data_(stat_suff.stat_suffix_data_) {}
-            StatSuffix_& operator=(const StatSuffix_& stat_suff)
-            {
-                if (this != &stat_suff)
-                {
-                    size_ = stat_suff.size_;
-                    start_ = stat_suff.start_;
-                    stat_suffix_data_ = stat_suff.stat_suffix_data_;
-                }
-                return *this;
-            }
-            StatSuffix(StatSuffix_&& stat_suff): size_(stat_suff.size_), start_(stat_suff.start_), stat_suffix_data_(std::move(stat_suff.stat_suffix_data_)) {}
-            StatSuffix_& operator=(StatSuffix_&& stat_suff)
-            {
-                if (this != &stat_suff)
-                {
-                    size_ = stat_suff.size_;
-                    start_ = stat_suff.start_;
-                    stat_suffix_data_ = std::move(stat_suff.stat_suffix_data_);
-                }
-                return *this;
-            }
+            StatSuffix(const StatSuffix_& stat_suff) = default;
+            StatSuffix_& operator=(const StatSuffix_& stat_suff) = default;
+            StatSuffix(StatSuffix_&& stat_suff) = default;
+            StatSuffix_& operator=(StatSuffix_&& stat_suff) = default;
 
             Type& operator[](size_t ind)
             {
-                if (ind >= capacity_ || ind >= size_) {std::__throw_out_of_range("StatSuffix");}
-                size_t shift = std::min(capacity_, size_);
-                return stat_suffix_data_[(capacity_ + start_ + shift - 1 - ind) % capacity_];
+                if (ind >= count()) {std::__throw_out_of_range("StatSuffix");}
+                return at_(ind);
             }
 
             const Type& operator[](size_t ind) const
             {
-                if (ind >= capacity_ || ind >= size_) {std::__throw_out_of_range("Suffix");}
-                size_t shift = std::min(capacity_, size_);
-                return stat_suffix_data_[(capacity_ + start_ + shift - 1 - ind) % capacity_];
+                if (ind >= count()) {std::__throw_out_of_range("StatSuffix");}
+                return at_(ind);
+            }
+
+            // Buffers of the evicted element are reused by push(const&) and push_slot() only, as in Suffix.
+            void push(const Type& item) {push_slot() = item;}
+            void push(Type&& item) {push_slot() = std::move(item);}
+            template<class... Args>
+            Type& emplace(Args&&... args)
+            {
+                Type& slot = push_slot();
+                slot = Type(std::forward<Args>(args)...);
+                return slot;
             }
 
-            void push(Type item)
+            Type& push_slot()
             {
-                size_t shift = std::min(capacity_, size_);
-                stat_suffix_data_[(start_ + shift) % capacity_] = std::move(item);
-                if (shift == capacity_) {(++start_) %= capacity_;}
+                size_t shift = count();
+                Type& slot = stat_suffix_data_[wrap_(start_ + shift)];
+                if (shift == capacity_) {start_ = wrap_(start_ + 1);}
                 ++size_;
+                return slot;
             }
 
+            iterator begin() {return iterator(this, 0);}
+            iterator end() {return iterator(this, count());}
+            const_iterator begin() const {return const_iterator(this, 0);}
+            const_iterator end() const {return const_iterator(this, count());}
+            const_iterator cbegin() const {return begin();}
+            const_iterator cend() const {return end();}
+
             size_t size() const {return size_;}
+            size_t count() const {return std::min(capacity_, size_);}
+            bool empty() const {return size_ == 0;}
             size_t capacity() const {return capacity_;}
             size_t start() const {return start_;}
 
         protected:
+            // pos < 2 * capacity_
+            static size_t wrap_(size_t pos)
+            {
+                if constexpr ((capacity_ & (capacity_ - 1)) == 0) {return pos & (capacity_ - 1);}
+                else {return pos >= capacity_ ? pos - capacity_ : pos;}
+            }
+
+            Type& at_(size_t ind) {return stat_suffix_data_[wrap_(start_ + count() - 1 - ind)];}
+            const Type& at_(size_t ind) const {return stat_suffix_data_[wrap_(start_ + count() - 1 - ind)];}
+
             size_t size_;
             size_t start_;
             StatSuffixData_ stat_suffix_data_;
         };
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+
+namespace HeuristicAlgorithm
+{
+    namespace Tools
+    {
+        class WorkerPool
+        {
+        public:
+            using Task_ = std::function<void(size_t, size_t)>;
+
+            WorkerPool(size_t num_threads = std::thread::hardware_concurrency())
+            {
+                if (num_threads == 0)
+                {
+                    num_threads = 1;
+                }
+                // the calling thread takes part in every parallel_for, so one thread less is spawned
+                threads_.reserve(num_threads - 1);
+                for (size_t i = 0; i + 1 < num_threads; ++i)
+                {
+                    threads_.emplace_back(&WorkerPool::run, this);
+                }
+            }
+
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    quit_ = true;
+                }
+                job_cv_.notify_all();
+                for (auto& thread: threads_)
+                {
+                    thread.join();
+                }
+            }
+
+            size_t size() const { return threads_.size() + 1; }
+
+            // Calls fun(begin, end) for consecutive chunks of [0, num_items) and blocks until all chunks are done.
+            // chunk_size == 0 splits the range into a few chunks per thread.
+            // A call made from inside a chunk of this pool (nested parallel_for) runs the whole range inline.
+            void parallel_for(size_t num_items, const Task_& fun, size_t chunk_size = 0)
+            {
+                if (num_items == 0)
+                {
+                    return;
+                }
+                if (chunk_size == 0)
+                {
+                    chunk_size = std::max<size_t>(1, num_items / (size() * 4));
+                }
+                if (threads_.empty() || num_items <= chunk_size || current_pool_() == this)
+                {
+                    fun(0, num_items);
+                    return;
+                }
+
+                std::lock_guard<std::mutex> submit_lock(submit_mtx_);
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    task_ = &fun;
+                    num_items_ = num_items;
+                    chunk_size_ = chunk_size;
+                    num_chunks_ = (num_items + chunk_size - 1) / chunk_size;
+                    next_chunk_.store(0, std::memory_order_relaxed);
+                    exception_ = nullptr;
+                    ++epoch_;
+                }
+                job_cv_.notify_all();
+
+                const WorkerPool* outer_pool = current_pool_();
+                current_pool_() = this;
+                process_chunks_(fun);
+                current_pool_() = outer_pool;
+
+                std::unique_lock<std::mutex> lock(mtx_);
+                done_cv_.wait(lock, [this]() -> bool { return active_ == 0; });
+                task_ = nullptr;
+                if (exception_)
+                {
+                    std::rethrow_exception(exception_);
+                }
+            }
+
+        protected:
+            // Pool whose chunks the current thread is running, the blocking part of parallel_for must not be re-entered from them.
+            static const WorkerPool*& current_pool_()
+            {
+                static thread_local const WorkerPool* pool = nullptr;
+                return pool;
+            }
+
+            void process_chunks_(const Task_& fun)
+            {
+                for (size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed); chunk < num_chunks_;
+                     chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed))
+                {
+                    size_t begin = chunk * chunk_size_;
+                    size_t end = std::min(num_items_, begin + chunk_size_);
+                    try
+                    {
+                        fun(begin, end);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mtx_);
+                        if (!exception_)
+                        {
+                            exception_ = std::current_exception();
+                        }
+                        next_chunk_.store(num_chunks_, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            void run()
+            {
+                current_pool_() = this;
+                size_t seen_epoch = 0;
+                std::unique_lock<std::mutex> lock(mtx_);
+                while (true)
+                {
+                    job_cv_.wait(lock, [this, seen_epoch]() -> bool { return quit_ || (task_ && epoch_ != seen_epoch); });
+                    if (quit_)
+                    {
+                        return;
+                    }
+                    seen_epoch = epoch_;
+                    const Task_& fun = *task_;
+                    ++active_;
+                    lock.unlock();
+
+                    process_chunks_(fun);
+
+                    lock.lock();
+                    if (--active_ == 0)
+                    {
+                        done_cv_.notify_all();
+                    }
+                }
+            }
+
+            std::vector<std::thread> threads_;
+
+            std::mutex submit_mtx_;
+            std::mutex mtx_;
+            std::condition_variable job_cv_;
+            std::condition_variable done_cv_;
+
+            const Task_* task_ = nullptr;
+            size_t num_items_ = 0;
+            size_t chunk_size_ = 1;
+            size_t num_chunks_ = 0;
+            std::atomic<size_t> next_chunk_{ 0 };
+            size_t epoch_ = 0;
+            size_t active_ = 0;
+            bool quit_ = false;
+            std::exception_ptr exception_;
+        };
+    }
+}
@@ -0,0 +1,160 @@
+#include "../src/genetic_algorithm/genetic_algorithm.hpp"
+#include "../src/genetic_algorithm/operators.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+// Counts every heap allocation of the process while counting_ is on.
+static std::atomic<bool> counting_{ false };
+static std::atomic<size_t> num_allocations_{ 0 };
+
+void* operator new(size_t size)
+{
+    if (counting_)
+    {
+        ++num_allocations_;
+    }
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+using namespace HeuristicAlgorithm::GeneticAlgorithm;
+using HeuristicAlgorithm::Tools::Random;
+
+using Chromosome_ = Chromosome<double, double>;
+using Population_ = Population<double, double>;
+
+struct SquaresSum: FitnessFunctionWrapper<double, double>
+{
+    double operator()(const Chromosome_& chromosome) override
+    {
+        double res = 0;
+        for (double gene: chromosome.cget())
+        {
+            res -= gene * gene;
+        }
+        return res;
+    }
+};
+
+// Starts counting after num_warmup generations and stops the run num_counted generations later.
+struct CountingStop: ConditionsForStoppingWrapper<double, double>
+{
+    CountingStop(size_t num_warmup, size_t num_counted): num_warmup_(num_warmup), num_counted_(num_counted) {}
+
+    bool operator()(const Population_& population) override
+    {
+        if (population.get().size() == num_warmup_)
+        {
+            num_allocations_ = 0;
+            counting_ = true;
+        }
+        if (population.get().size() == num_warmup_ + num_counted_)
+        {
+            counting_ = false;
+            return true;
+        }
+        return false;
+    }
+
+    size_t num_warmup_;
+    size_t num_counted_;
+};
+
+// Whole-generation crossingover: returns a new generation, so its own allocations are unavoidable and are counted apart.
+struct WholeGenerationCrossingover: CrossingoverWrapper<double, double>
+{
+    WholeGenerationCrossingover(size_t num_offspring, std::shared_ptr<Random> random): num_offspring_(num_offspring), random_(random) {}
+
+    Generation<double, double> operator()(const Population_& population) override
+    {
+        size_t num_allocations = num_allocations_;
+        const auto& parents = population.get()[0].get();
+        Generation<double, double> res;
+        res.get().reserve(num_offspring_);
+        for (size_t i = 0; i < num_offspring_; ++i)
+        {
+            const Chromosome_& first = parents[random_->uniformInt(parents.size())];
+            const Chromosome_& second = parents[random_->uniformInt(parents.size())];
+            size_t point = random_->uniformInt(first.cget().size());
+            Chromosome_ offspring(first.cget());
+            std::copy(second.cget().begin() + point, second.cget().end(), offspring.get().begin() + point);
+            res.get().push_back(std::move(offspring));
+        }
+        num_operator_allocations_ += num_allocations_ - num_allocations;
+        return res;
+    }
+
+    size_t num_offspring_;
+    std::shared_ptr<Random> random_;
+    size_t num_operator_allocations_ = 0;
+};
+
+enum class Mode { chromosome, fused, generation };
+
+// Allocations made in the counted generations apart from the ones of the crossingover operator itself.
+static size_t run(Mode mode)
+{
+    const size_t num_chromosomes = 64;
+    const size_t num_genes = 32;
+
+    Random random(1);
+    Population_ population(4);
+    Generation<double, double> generation;
+    for (size_t i = 0; i < num_chromosomes; ++i)
+    {
+        Chromosome_ chromosome(num_genes, 0.);
+        for (auto&& gene: chromosome.get())
+        {
+            gene = random.uniformReal(-1., 1.);
+        }
+        generation.get().push_back(chromosome);
+    }
+    population.get().push(generation);
+
+    GeneticAlgorithm<double, double> ga;
+    ga.setSeed(7);
+    ga.setRecycling(true);
+    ga.setFused(mode == Mode::fused, 8);
+    ga.setFitnessFunction(std::make_shared<SquaresSum>());
+    ga.setConditionsForStopping(std::make_shared<CountingStop>(10, 50));
+    ga.setSelection(std::make_shared<TournamentSelection<double, double>>(num_chromosomes, 2, ga.getRandom()));
+    ga.setChromosomeMutation(std::make_shared<GaussianMutation<double>>(0.1, 0.1, -1., 1.));
+    auto crossingover = std::make_shared<WholeGenerationCrossingover>(num_chromosomes, ga.getRandom());
+    if (mode == Mode::generation)
+    {
+        ga.setCrossingover(crossingover);
+    }
+    else
+    {
+        ga.setChromosomeCrossingover(std::make_shared<KPointCrossingover<double, double>>(2), num_chromosomes);
+    }
+    ga.evolution(population);
+    return num_allocations_ - crossingover->num_operator_allocations_;
+}
+
+int main()
+{
+    int res = 0;
+    const char* names[] = { "chromosome crossingover", "fused", "generation crossingover" };
+    for (Mode mode: {Mode::chromosome, Mode::fused, Mode::generation})
+    {
+        size_t num_allocations = run(mode);
+        std::printf("%s: %zu allocations in 50 recycled generations\n", names[int(mode)], num_allocations);
+        if (num_allocations != 0)
+        {
+            res = 1;
+        }
+    }
+    return res;
+}